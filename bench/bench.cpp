@@ -0,0 +1,168 @@
+// End-to-end benchmark of the five games, built with "make -f src/makefile bench" on Linux.
+// Every game runs headless with a fixed seed and fixed synthesized input, draws each tick with the software
+// renderer into an offscreen surface, and the results are printed to stdout as one JSON document.
+// AstroStrike runs a second time in its stress mode, to show how the engine holds up under thousands of entities.
+// The Tetris bot then plays on its own, without the game around it, to measure how many placements it scores per second.
+// A scenario fails when one of its frames takes over a second, which only a sleep in the game loop can cause.
+// Run it from the repository root so the games find their images and fonts.
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "games.hpp"
+using namespace std;
+
+struct Scenario
+{
+    const char *game;
+    unsigned int seed;
+    Uint64 ticks;
+    vector<SDL_Scancode> keys; // keys the synthesized input presses
+    bool stress;               // AstroStrike's stress mode, the game's name is reported with "-stress"
+};
+
+enum
+{
+    StallMs = 1000,  // no tick and its frame may take this long, 60 times the tick budget; only a sleep gets there
+    StalledExit = 2  // the scenario's exit status when one did, its JSON is complete and says so
+};
+
+// runs one scenario and prints its JSON object, meant to run in a process of its own so the peak memory is its own
+int runScenario(const Scenario &scenario)
+{
+    Arcade::HeadlessSettings &headless = Arcade::headlessSettings();
+    headless.enabled = true;
+    headless.render = true;
+    headless.maxTicks = scenario.ticks;
+    headless.profileFrames = int(scenario.ticks); // keep every tick, the percentiles cover the whole run
+    Arcade::loopSettings().profilerCsv = false;
+    Arcade::loopSettings().seed = scenario.seed;
+    AstroStrike::stressSettings().enabled = scenario.stress;
+
+    InputScript input;
+    input.synthesize(scenario.seed, scenario.ticks, scenario.keys);
+    headless.input = &input;
+
+    Arcade *game = createGame(scenario.game);
+    game->run();
+    const FrameProfiler &profile = game->frameProfile();
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage); // ru_maxrss is in kilobytes on Linux
+    double longest = profile.percentile(100);
+    bool stalled = longest > StallMs;
+
+    printf("    {\"game\": \"%s\", \"seed\": %u, \"ticks\": %llu, \"seconds\": %.3f, \"fps\": %.1f, \"updates_per_second\": %.1f, "
+           "\"update_ms\": {\"p50\": %.4f, \"p99\": %.4f}, \"render_ms\": {\"p50\": %.4f, \"p99\": %.4f}, "
+           "\"frame_ms\": {\"p50\": %.4f, \"p99\": %.4f, \"max\": %.4f}, \"stalled\": %s, \"peak_rss_kb\": %ld}",
+           (string(scenario.game) + (scenario.stress ? "-stress" : "")).c_str(), scenario.seed, (unsigned long long)game->tickCount(), profile.totalSeconds(), profile.framesPerSecond(),
+           game->updatesPerSecond(),
+           profile.phasePercentile(FrameProfiler::Update, 50), profile.phasePercentile(FrameProfiler::Update, 99),
+           profile.phasePercentile(FrameProfiler::Render, 50), profile.phasePercentile(FrameProfiler::Render, 99),
+           profile.percentile(50), profile.percentile(99), longest, stalled ? "true" : "false", usage.ru_maxrss);
+    fflush(stdout);
+    delete game;
+    return stalled ? StalledExit : 0;
+}
+
+// the bot places pieces on a bare board as fast as it can, the board starts over whenever the stack reaches the top
+void runBotThroughput(unsigned int seed, Uint64 pieces)
+{
+    typedef TetrisBoard<20, 10> Board; // the classic board the game uses
+    TetrisBot<Board> bot;
+    Rng rng(seed);
+    Board board;
+    int next = rng.below(TetrisPieces::Figures);
+    Uint64 lines = 0, games = 1;
+    for (Uint64 i = 0; i < pieces; i++)
+    {
+        int figure = next;
+        next = rng.below(TetrisPieces::Figures);
+        TetrisBotMove move = bot.choose(board, figure, next);
+        if (move.found)
+        {
+            TetrisCell cells[4];
+            TetrisPieces::cells(move.piece, cells);
+            board.place(cells, 1);
+            lines += board.clearLines();
+        }
+        if (!move.found || board.reachedTop())
+        {
+            board.clear();
+            games++;
+        }
+    }
+    double seconds = bot.searchSeconds();
+    printf("  \"tetris_bot\": {\"seed\": %u, \"threads\": %d, \"pieces\": %llu, \"games\": %llu, \"lines\": %llu, \"placements\": %llu, "
+           "\"seconds\": %.3f, \"placements_per_second\": %.0f}\n",
+           seed, bot.threadCount(), (unsigned long long)pieces, (unsigned long long)games, (unsigned long long)lines,
+           (unsigned long long)bot.placementCount(), seconds, seconds > 0 ? bot.placementCount() / seconds : 0.0);
+}
+
+int main(int argc, char *argv[])
+{
+    // "arcade_bench [ticks]", every game gets the same number of ticks (default 3600, one minute of game time)
+    Uint64 ticks = argc > 1 ? strtoull(argv[1], nullptr, 10) : 3600;
+    if (!ticks)
+        ticks = 3600;
+
+    // SDL should not look for a display or a sound card, nothing is shown or played
+    setenv("SDL_VIDEODRIVER", "dummy", 1);
+    setenv("SDL_AUDIODRIVER", "dummy", 1);
+
+    const SDL_Scancode arrows[] = {SDL_SCANCODE_LEFT, SDL_SCANCODE_RIGHT, SDL_SCANCODE_UP, SDL_SCANCODE_DOWN};
+    vector<SDL_Scancode> arrowKeys(arrows, arrows + 4);
+    vector<SDL_Scancode> shooterKeys(arrowKeys);
+    shooterKeys.push_back(SDL_SCANCODE_SPACE);
+    vector<SDL_Scancode> pongKeys(arrowKeys);
+    pongKeys.push_back(SDL_SCANCODE_W);
+    pongKeys.push_back(SDL_SCANCODE_S);
+
+    Scenario scenarios[] = {
+        {"astrostrike", 1001, ticks, shooterKeys, false},
+        {"spookychase", 1002, ticks, arrowKeys, false},
+        {"mindmaze", 1003, ticks, arrowKeys, false},
+        {"pingpong", 1004, ticks, pongKeys, false},
+        {"tetris", 1005, ticks, shooterKeys, false},
+        {"astrostrike", 1006, ticks, shooterKeys, true}, // thousands of projectiles, where the engine gives in
+    };
+    const int scenarioCount = sizeof(scenarios) / sizeof(scenarios[0]);
+
+    printf("{\n  \"tick_rate\": %d,\n  \"scenarios\": [\n", Arcade::loopSettings().tickRate);
+    int failures = 0;
+    for (int i = 0; i < scenarioCount; i++)
+    {
+        fflush(stdout); // the child would print whatever is still buffered a second time
+        pid_t child = fork();
+        if (child == 0)
+        {
+            // the games log to cout; only the JSON may reach stdout
+            freopen("/dev/null", "w", stderr);
+            cout.rdbuf(cerr.rdbuf());
+            _exit(runScenario(scenarios[i]));
+        }
+        int status = 0;
+        bool finished = child >= 0 && waitpid(child, &status, 0) >= 0 && WIFEXITED(status);
+        if (finished && WEXITSTATUS(status) == StalledExit)
+        {
+            // something slept on the simulation or render path, the timings above are not the engine's
+            fprintf(stderr, "%s%s: a frame took longer than %d ms\n", scenarios[i].game, scenarios[i].stress ? "-stress" : "", int(StallMs));
+            failures++;
+        }
+        else if (!finished || WEXITSTATUS(status) != 0)
+        {
+            printf("    {\"game\": \"%s%s\", \"error\": \"scenario did not finish\"}", scenarios[i].game, scenarios[i].stress ? "-stress" : "");
+            failures++;
+        }
+        printf(i + 1 < scenarioCount ? ",\n" : "\n");
+    }
+    printf("  ],\n");
+    runBotThroughput(1007, ticks); // a piece per tick of the other scenarios
+    printf("}\n");
+    return failures ? 1 : 0;
+}
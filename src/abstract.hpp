@@ -2,54 +2,677 @@
 #define ARCADE_H
 // Above are preprocessor directives that guard against multiple inclusion of the same header file.
 
+#include "scoreStore.hpp" // first, it may pull in windows.h
+#include <SDL2/SDL_mixer.h>
 #include <string>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <iterator>
+#include "assetCache.hpp"
+#include "frameProfiler.hpp"
+#include "framePacer.hpp"
+#include "inputRecording.hpp"
+#include "inputScript.hpp"
+#include "rng.hpp"
+#include "session.hpp"
+#include "snapshotBuffer.hpp"
+#include "spriteBatch.hpp"
+#include "textRenderer.hpp"
 using namespace std;
 class Arcade
 {
 public:
-    Arcade(const char *n = "", int w = 700, int h = 700) : gameName(n), Width(w), Height(h), window(nullptr), renderer(nullptr)
-    {
-        SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO); // SDL_Init initializes the SDL. The parameter specifies what part(s)/subsystems of SDL to initialize.
-
-        window = SDL_CreateWindow(gameName, SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, Width, Height, SDL_WINDOW_SHOWN);
-        // SDL_CreateWindow creates a window for the game with the title "PONG" and dimensions specified by WIDTH and HEIGHT constants.
-
-        renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
-        // SDL_CreateRenderer creates a hardware-accelerated renderer associated with the game window.
-        IMG_Init(IMG_INIT_PNG);                            // This initializes the SDL_image extension with support for PNG image loading.
-        IMG_Init(IMG_INIT_JPG);                            // This initializes the SDL_image extension with support for PNG image loading.
-        TTF_Init();                                        // TTF_Init() initializes SDL_ttf which allows to load and render TrueType fonts in SDL applications.
-        Mix_Init(MIX_INIT_MP3);                            // This line initializes specific components of the SDL_mixer library for handling MP3 audio format.
-        Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048); // This initializes the SDL_mixer extension for audio mixing. It specifies the audio format and parameters
-    }
-    ~Arcade()
-    {
-        TTF_CloseFont(font);
-        TTF_CloseFont(msgfont);
-        Mix_FreeMusic(backgroundMusic);
-        Mix_CloseAudio();
-        SDL_DestroyRenderer(renderer);
-        SDL_DestroyWindow(window);
-        TTF_Quit();
-        Mix_Quit();
-        IMG_Quit();
-        SDL_Quit();
+    // how the game loop is paced, shared by every game of the process
+    struct LoopSettings
+    {
+        int tickRate = 60;  // simulation ticks per second, all movement speeds are per tick
+        int frameRate = 60; // frames rendered per second, 0 renders as fast as possible (or as vsync allows)
+        bool vsync = false; // wait for the display refresh when presenting
+        bool profilerOverlay = false; // start with the profiler overlay shown, F3 toggles it while playing
+        bool profilerCsv = true;      // write profile-<game>.csv with the last frames when a game's loop ends
+        Uint64 seed = 0;              // seed for every game's Rng, 0 picks a new one from the clock for each run
+        bool simulationThread = true; // games that publish snapshots simulate on a worker thread, see runThreaded()
+        bool record = false;          // write replay-<game>.rec with the seed, the keys and the state checksums of every game played
+        Uint32 checkInterval = 1;     // ticks between two state checksums of a recording
+    };
+
+    static LoopSettings &loopSettings()
+    {
+        static LoopSettings settings;
+        return settings;
+    }
+
+    // headless runs are for benchmarking the simulation on machines without a display, GPU or sound card
+    struct HeadlessSettings
+    {
+        bool enabled = false;         // no window, renderer or audio device; the loop runs ticks back to back without rendering
+        Uint64 maxTicks = 0;          // a headless run stops after this many ticks, 0 runs until the game ends
+        InputScript *input = nullptr; // scripted keyboard for headless runs, nullptr means no key is ever pressed
+        bool render = false;          // draw every tick with a software renderer into an offscreen surface, to measure render times
+        int profileFrames = 0;        // frames the profiler keeps in a headless run, 0 keeps FrameProfiler::HistorySize
+        const InputRecording *replay = nullptr; // the run is checked against this recording's checksums, its keys come through input
+    };
+
+    static HeadlessSettings &headlessSettings()
+    {
+        static HeadlessSettings settings;
+        return settings;
+    }
+
+    Arcade(const char *n = "", int w = 700, int h = 700) : gameName(n), window(nullptr), renderer(nullptr), backgroundMusic(nullptr), Width(w), Height(h), assets(session().assets), textRenderer(session().text), sprites(session().sprites), sounds(session().sounds), ticks(0), recordingInput(false), replayChecks(0), replayDivergedAt(0), interpolationAlpha(1.0), loopSeconds(0), runSeed(1), headless(headlessSettings().enabled)
+    {
+        // the first game brings the session up, every later one (and every game started from the menu) reuses it
+        instances()++;
+        scores(); // the leaderboards are read from disk once, before any game starts
+        Session &current = session();
+        assets.setArchive(&archive());
+        sounds.setArchive(&archive());
+        fonts().setArchive(&archive());
+        current.open(gameName, Width, Height, headless, headlessSettings().render, loopSettings().vsync);
+        current.enter(gameName, Width, Height);
+        window = current.window;
+        renderer = current.renderer;
+    }
+    virtual ~Arcade()
+    {
+        if (backgroundMusic)
+            Mix_FreeMusic(backgroundMusic); // also stops it if it is still playing
+        if (--instances() == 0)
+        {
+            scores().close();  // waits for scores that are still being written
+            session().close(); // the last game is gone, so is the arcade
+        }
     }
     virtual void run() = 0;
     virtual bool initialize() = 0;
     virtual void handleEvents() = 0;
     virtual void cleanup() = 0;
 
+    Uint64 tickCount() const
+    {
+        return ticks;
+    }
+
+    double updatesPerSecond() const
+    {
+        // simulation throughput of the last runLoop(), the number headless benchmarks report
+        return loopSeconds > 0 ? ticks / loopSeconds : 0;
+    }
+
+    const FrameProfiler &frameProfile() const
+    {
+        return profiler;
+    }
+
+    Uint64 rngSeed() const
+    {
+        // the seed of the current run, running again with it reproduces the same game
+        return runSeed;
+    }
+
+    bool replayDiverged() const
+    {
+        // a replay whose state stopped matching the recording's checksums
+        return replayDivergedAt != 0;
+    }
+
 protected:
+    // one simulation step, called tickRate times per second by runLoop()
+    virtual void update() = 0;
+    // draws the current state, without presenting it; interpolate() blends between the last two ticks
+    virtual void render() = 0;
+    // runLoop() keeps going while this returns true
+    virtual bool isRunning() = 0;
+    // number of live entities, shown by the profiler next to the frame times
+    virtual int entityCount()
+    {
+        return 0;
+    }
+    // a hash of the game's state (StateHash), recordings compare it between a run and its replay;
+    // Arcade adds the tick count and the Rng, the game adds what its ticks change
+    virtual Uint32 stateChecksum()
+    {
+        return 0;
+    }
+
+    // A game that publishes snapshots keeps the devices, the simulation and the drawing apart: pollInput() reads
+    // the devices into an input buffer, handleEvents() and update() only read that buffer and the game state,
+    // publishSnapshot() copies what render() needs, and render() only draws the snapshot acquireSnapshot() took.
+    // runLoop() can then run the ticks on a worker thread; a game that does not runs them between its frames.
+    virtual bool publishesSnapshots()
+    {
+        return false;
+    }
+    // main thread, before the ticks it runs (or before every frame when a worker runs them)
+    virtual void pollInput() {}
+    // after every tick, on the thread that ran it; tickTime is the performance counter time the tick stands for
+    virtual void publishSnapshot(Uint64 /*tickTime*/) {}
+    // main thread, before render(): picks the newest published snapshot and returns its tickTime
+    virtual Uint64 acquireSnapshot()
+    {
+        return 0;
+    }
+
+    enum
+    {
+        MaxTicksPerFrame = 5 // after a stall the simulation slows down instead of trying to catch up forever
+    };
+
+    void runLoop()
+    {
+        // fixed-timestep game loop: input and simulation advance in ticks of equal length, so the game
+        // runs at the same speed on every machine, while frames are rendered as often as the pacer allows
+        if (headless)
+        {
+            runHeadless();
+            return;
+        }
+        // a recording needs to know which tick every key belongs to, so it keeps the ticks on this thread
+        bool recordInput = loopSettings().record;
+        if (recordInput)
+            startRecording();
+        if (loopSettings().simulationThread && publishesSnapshots() && !recordInput && SDL_GetCPUCount() > 1)
+            runThreaded();
+        else
+            runSerial();
+        if (recordInput)
+            finishRecording();
+    }
+
+    void runSerial()
+    {
+        // input, ticks and the frame one after the other on this thread
+        const LoopSettings &settings = loopSettings();
+        const Uint64 tickLength = SDL_GetPerformanceFrequency() / settings.tickRate;
+        FramePacer pacer(settings.frameRate);
+        Uint64 previous = SDL_GetPerformanceCounter();
+        Uint64 accumulator = tickLength; // the first frame runs one tick right away
+        bool showProfiler = settings.profilerOverlay, toggleHeld = false;
+        profiler = FrameProfiler();
+        sounds.resetStats();
+
+        while (isRunning())
+        {
+            profiler.beginFrame();
+            sprites.resetCounters();
+            Uint64 now = SDL_GetPerformanceCounter();
+            accumulator += now - previous;
+            previous = now;
+            if (accumulator > tickLength * MaxTicksPerFrame)
+                accumulator = tickLength * MaxTicksPerFrame;
+
+            while (accumulator >= tickLength && isRunning())
+            {
+                runTick();
+                accumulator -= tickLength;
+            }
+            sounds.flush(); // the sounds of this frame's ticks, one voice per sound at most
+
+            bool toggle = keyboardState()[SDL_SCANCODE_F3] != 0;
+            if (toggle && !toggleHeld)
+                showProfiler = !showProfiler;
+            toggleHeld = toggle;
+
+            // how far the clock is between the last tick and the next one, used to smooth movement
+            interpolationAlpha = double(accumulator) / double(tickLength);
+            if (interpolationAlpha > 1.0)
+                interpolationAlpha = 1.0;
+            acquireSnapshot(); // the ticks just ran here, the newest snapshot is the current state
+            Uint64 phaseStart = FrameProfiler::now();
+            render();
+            sprites.flush(); // whatever the game left in the batch is drawn now, below the overlay
+            profiler.add(FrameProfiler::Render, FrameProfiler::now() - phaseStart);
+            if (showProfiler) // drawn outside the render phase so the overlay does not measure itself
+                profiler.drawOverlay(renderer, textRenderer, fonts().get("arial.ttf", 14), 1000.0 / (settings.frameRate > 0 ? settings.frameRate : settings.tickRate));
+            phaseStart = FrameProfiler::now();
+            SDL_RenderPresent(renderer);
+            profiler.add(FrameProfiler::Present, FrameProfiler::now() - phaseStart);
+            pacer.wait();
+            profiler.endFrame(entityCount(), sprites.drawCallCount(), sprites.spriteCount());
+        }
+        writeProfile();
+        reportSounds();
+    }
+
+    void runTick()
+    {
+        // one input and simulation step, timed phase by phase
+        Uint64 phaseStart = FrameProfiler::now();
+        pollInput();
+        profiler.add(FrameProfiler::Events, FrameProfiler::now() - phaseStart);
+        SimulationTimes times;
+        simulateTick(FrameProfiler::now(), times);
+        profiler.add(FrameProfiler::Events, times.events);
+        profiler.add(FrameProfiler::Update, times.update);
+        profiler.countTick();
+    }
+
+    // time spent in handleEvents() and update(), added up until someone takes them
+    struct SimulationTimes
+    {
+        Uint64 events = 0;
+        Uint64 update = 0;
+        int ticks = 0;
+    };
+
+    void simulateTick(Uint64 tickTime, SimulationTimes &times)
+    {
+        // handleEvents() and update() of one tick, on whichever thread runs the simulation
+        Uint64 phaseStart = FrameProfiler::now();
+        handleEvents();
+        Uint64 updateStart = FrameProfiler::now();
+        times.events += updateStart - phaseStart;
+        update();
+        times.update += FrameProfiler::now() - updateStart;
+        times.ticks++;
+        ticks++;
+        if (recordingInput || headlessSettings().replay)
+            checkState();
+        publishSnapshot(tickTime);
+    }
+
+    void startRecording()
+    {
+        // every key event SDL queues from now on is stamped with the tick whose handleEvents() will read it
+        recording = InputRecording();
+        recording.game = gameName;
+        recording.seed = runSeed;
+        recording.tickRate = Uint32(loopSettings().tickRate);
+        recording.checkInterval = loopSettings().checkInterval > 0 ? loopSettings().checkInterval : 1;
+        recordingInput = true;
+        const Uint8 *held = SDL_GetKeyboardState(NULL);
+        for (int key = 0; key < SDL_NUM_SCANCODES; key++)
+            if (held[key])
+                recording.addKey(0, SDL_Scancode(key), true, false); // keys already down when the game starts
+        SDL_AddEventWatch(recordKey, this);
+    }
+
+    static int SDLCALL recordKey(void *data, SDL_Event *event)
+    {
+        Arcade *game = static_cast<Arcade *>(data);
+        if (event->type == SDL_KEYDOWN || event->type == SDL_KEYUP)
+            game->recording.addKey(game->ticks, event->key.keysym.scancode, event->type == SDL_KEYDOWN, event->key.repeat != 0);
+        return 1;
+    }
+
+    void finishRecording()
+    {
+        SDL_DelEventWatch(recordKey, this);
+        recordingInput = false;
+        recording.ticks = ticks;
+        string path = string("replay-") + gameName + ".rec";
+        if (recording.save(path))
+            cout << "Recorded " << ticks << " ticks of " << gameName << " (seed " << runSeed << ") to " << path << endl;
+    }
+
+    void checkState()
+    {
+        // after every checkInterval-th tick: the recording takes the checksum, a replay compares it
+        const InputRecording *replay = headlessSettings().replay;
+        Uint32 interval = replay ? replay->checkInterval : recording.checkInterval;
+        if (ticks % interval)
+            return;
+        StateHash hash;
+        hash.add(ticks).add(rng.stateWords(), 4 * sizeof(Uint64)).add(stateChecksum());
+        if (!replay)
+        {
+            recording.checksums.push_back(hash.result());
+            return;
+        }
+        size_t index = size_t(ticks / interval - 1);
+        if (index >= replay->checksums.size())
+            return;
+        replayChecks++;
+        if (hash.result() != replay->checksums[index] && !replayDivergedAt)
+            replayDivergedAt = ticks;
+    }
+
+    void runThreaded()
+    {
+        // the worker runs the ticks at the tick rate and publishes a snapshot after each one; this thread only
+        // polls the devices and draws the newest snapshot, so a slow tick delays the next snapshot but not the frame
+        const LoopSettings &settings = loopSettings();
+        const Uint64 tickLength = SDL_GetPerformanceFrequency() / settings.tickRate;
+        FramePacer pacer(settings.frameRate);
+        bool showProfiler = settings.profilerOverlay, toggleHeld = false;
+        profiler = FrameProfiler();
+        sounds.resetStats();
+
+        pollInput();
+        publishSnapshot(FrameProfiler::now()); // the first frame has something to draw
+        workerTickLength = tickLength;
+        SDL_AtomicSet(&workerStop, 0);
+        SDL_AtomicSet(&workerDone, 0);
+        SDL_Thread *worker = SDL_CreateThread(simulationWorker, "simulation", this);
+        if (!worker)
+        {
+            // without a worker the ticks run between the frames instead
+            cout << "Failed to start the simulation thread: " << SDL_GetError() << endl;
+            runSerial();
+            return;
+        }
+
+        SimulationTimes counted;
+        Uint64 drawnTick = 0;
+        while (!SDL_AtomicGet(&workerDone))
+        {
+            profiler.beginFrame();
+            sprites.resetCounters();
+            Uint64 phaseStart = FrameProfiler::now();
+            pollInput();
+            profiler.add(FrameProfiler::Events, FrameProfiler::now() - phaseStart);
+
+            // the worker's timings come in totals, the frame gets what was added since the last one
+            if (workerTimes.acquire())
+            {
+                const SimulationTimes &total = workerTimes.latest();
+                profiler.add(FrameProfiler::Events, total.events - counted.events);
+                profiler.add(FrameProfiler::Update, total.update - counted.update);
+                for (int i = counted.ticks; i < total.ticks; i++)
+                    profiler.countTick();
+                counted = total;
+            }
+            sounds.flush(); // whatever the worker asked for since the last frame
+
+            bool toggle = keyboardState()[SDL_SCANCODE_F3] != 0;
+            if (toggle && !toggleHeld)
+                showProfiler = !showProfiler;
+            toggleHeld = toggle;
+
+            // the snapshot is as old as the time since its tick, which is how far to blend towards it
+            Uint64 tickTime = drawnTick = acquireSnapshot(), now = FrameProfiler::now();
+            interpolationAlpha = now > tickTime ? double(now - tickTime) / double(tickLength) : 0.0;
+            if (interpolationAlpha > 1.0)
+                interpolationAlpha = 1.0;
+            phaseStart = FrameProfiler::now();
+            render();
+            sprites.flush();
+            profiler.add(FrameProfiler::Render, FrameProfiler::now() - phaseStart);
+            if (showProfiler)
+                profiler.drawOverlay(renderer, textRenderer, fonts().get("arial.ttf", 14), 1000.0 / (settings.frameRate > 0 ? settings.frameRate : settings.tickRate));
+            phaseStart = FrameProfiler::now();
+            SDL_RenderPresent(renderer);
+            profiler.add(FrameProfiler::Present, FrameProfiler::now() - phaseStart);
+            pacer.wait();
+            profiler.endFrame(entityCount(), sprites.drawCallCount(), sprites.spriteCount());
+        }
+        SDL_AtomicSet(&workerStop, 1);
+        SDL_WaitThread(worker, nullptr);
+
+        // the last tick may have come after the last frame; runSerial() always draws it, so does this
+        if (acquireSnapshot() != drawnTick)
+        {
+            interpolationAlpha = 1.0;
+            render();
+            sprites.flush();
+            SDL_RenderPresent(renderer);
+        }
+        writeProfile();
+        reportSounds();
+    }
+
+    static int SDLCALL simulationWorker(void *data)
+    {
+        // the fixed timestep of runLoop(), with the clock kept here and the frames left to the main thread
+        Arcade *game = static_cast<Arcade *>(data);
+        const Uint64 tickLength = game->workerTickLength, frequency = SDL_GetPerformanceFrequency();
+        SimulationTimes total;
+        Uint64 simulatedUntil = SDL_GetPerformanceCounter() - tickLength; // the first tick runs right away
+        while (!SDL_AtomicGet(&game->workerStop) && game->isRunning())
+        {
+            Uint64 now = SDL_GetPerformanceCounter();
+            if (now - simulatedUntil > tickLength * MaxTicksPerFrame)
+                simulatedUntil = now - tickLength * MaxTicksPerFrame;
+            while (simulatedUntil + tickLength <= now && game->isRunning())
+            {
+                simulatedUntil += tickLength;
+                game->simulateTick(simulatedUntil, total);
+                game->workerTimes.draft() = total;
+                game->workerTimes.publish(simulatedUntil);
+            }
+            now = SDL_GetPerformanceCounter();
+            if (now < simulatedUntil + tickLength)
+                SDL_Delay(Uint32((simulatedUntil + tickLength - now) * 1000 / frequency));
+        }
+        SDL_AtomicSet(&game->workerDone, 1);
+        return 0;
+    }
+
+    void writeProfile()
+    {
+        if (loopSettings().profilerCsv)
+            profiler.writeCsv(string("profile-") + gameName + ".csv");
+    }
+
+    void reportSounds()
+    {
+        // how the voices were handed out during the last loop, printed only if something had to give
+        const SoundEffects::Stats &stats = sounds.statistics();
+        if (stats.merged || stats.dropped || stats.stolen)
+            cout << gameName << " sound effects: " << stats.requested << " requested, " << stats.played << " played, "
+                 << stats.merged << " merged, " << stats.dropped << " dropped, " << stats.stolen << " stolen" << endl;
+    }
+
+    void runHeadless()
+    {
+        // ticks run back to back as fast as the machine allows, nothing is rendered or presented
+        const HeadlessSettings &settings = headlessSettings();
+        Uint64 start = SDL_GetPerformanceCounter();
+        profiler = FrameProfiler(settings.profileFrames > 0 ? settings.profileFrames : FrameProfiler::HistorySize);
+        while (isRunning() && (settings.maxTicks == 0 || ticks < settings.maxTicks))
+        {
+            // every tick is profiled as a frame of its own, and rendered too when there is an offscreen renderer
+            profiler.beginFrame();
+            sprites.resetCounters();
+            if (settings.input)
+                settings.input->apply(ticks);
+            runTick();
+            if (renderer)
+            {
+                acquireSnapshot();
+                Uint64 phaseStart = FrameProfiler::now();
+                render();
+                sprites.flush();
+                profiler.add(FrameProfiler::Render, FrameProfiler::now() - phaseStart);
+                phaseStart = FrameProfiler::now();
+                SDL_RenderPresent(renderer);
+                profiler.add(FrameProfiler::Present, FrameProfiler::now() - phaseStart);
+            }
+            profiler.endFrame(entityCount(), sprites.drawCallCount(), sprites.spriteCount());
+        }
+        loopSeconds = double(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+        writeProfile();
+        if (settings.replay)
+            reportReplay(*settings.replay);
+    }
+
+    void reportReplay(const InputRecording &replay)
+    {
+        cout << "Replay of " << replay.game << ": " << ticks << " of " << replay.ticks << " ticks, " << replayChecks << " checksums compared, ";
+        if (replayDivergedAt)
+            cout << "diverged at tick " << replayDivergedAt << endl;
+        else if (ticks != replay.ticks)
+            cout << "no difference, but the game ended at another tick" << endl;
+        else
+            cout << "identical" << endl;
+    }
+
+    Uint64 seedRng()
+    {
+        // every game calls this when a run starts, before anything random happens
+        runSeed = loopSettings().seed;
+        if (!runSeed)
+            runSeed = SDL_GetPerformanceCounter() ^ (Uint64(time(nullptr)) << 32);
+        rng.seed(runSeed);
+        return runSeed;
+    }
+
+    bool isHeadless() const
+    {
+        // headless games have no renderer and no audio device, so missing textures and sounds are expected
+        return headless;
+    }
+
+    const Uint8 *keyboardState() const
+    {
+        // games read held keys through this instead of SDL_GetKeyboardState(), so a script can drive them
+        const HeadlessSettings &settings = headlessSettings();
+        if (headless && settings.input)
+            return settings.input->keyboardState();
+        return SDL_GetKeyboardState(NULL);
+    }
+
+    Uint32 gameTime() const
+    {
+        // milliseconds of simulated time, games use this instead of SDL_GetTicks() for their timers
+        return Uint32(ticks * 1000 / loopSettings().tickRate);
+    }
+
+    Uint32 eventTime(Uint32 timestamp) const
+    {
+        // the game time an input event happened at, from its SDL timestamp: a tick reads the events of the time
+        // since the previous one, so they are placed up to a tick before gameTime(), in the order they came.
+        // Headless runs and recordings keep them on the tick itself, a replay could not repeat the timestamps
+        Uint32 now = gameTime();
+        if (headless || recordingInput)
+            return now;
+        Uint32 age = SDL_GetTicks() - timestamp, tick = Uint32(1000 / loopSettings().tickRate);
+        return now - min(age, min(tick, now));
+    }
+
+    int interpolate(int previous, int current) const
+    {
+        // position between the previous and the current tick for the frame being rendered
+        return previous + int(floor((current - previous) * interpolationAlpha + 0.5));
+    }
+
+    static ScoreStore &scores()
+    {
+        // leaderboards of every game, kept in memory and written to disk in the background
+        static ScoreStore store;
+        return store;
+    }
+
+    int highScore()
+    {
+        return scores().best(gameName);
+    }
+
+    bool submitScore(int score)
+    {
+        // headless runs are benchmarks, their scores are not real games
+        return !headless && scores().submit(gameName, score);
+    }
+
+    static AssetArchive &archive()
+    {
+        // assets.pak is mapped once for the whole process; without it every asset is loaded from its own file
+        static AssetArchive packed;
+        static bool tried = false;
+        if (!tried)
+        {
+            packed.open("assets.pak");
+            tried = true;
+        }
+        return packed;
+    }
+
+    SDL_Surface *loadSurface(const string &path)
+    {
+        // the archive's pixels are already decoded, otherwise the file is decoded; free the result with SDL_FreeSurface
+        SDL_Surface *surface = archive().surface(path);
+        return surface ? surface : IMG_Load(path.c_str());
+    }
+
+    Mix_Music *loadMusic(const string &path)
+    {
+        // music is streamed while it plays, which is fine since the mapping lives until the process ends
+        SDL_RWops *stream = archive().openRW(path);
+        return stream ? Mix_LoadMUS_RW(stream, 1) : Mix_LoadMUS(path.c_str());
+    }
+
+    bool loadText(const string &path, string &text)
+    {
+        const ArchiveEntry *entry = archive().find(path);
+        if (entry && entry->kind == ArchiveEntry::Raw)
+        {
+            text.assign(static_cast<const char *>(archive().data(*entry)), size_t(entry->size));
+            return true;
+        }
+        ifstream file(path, ios::binary);
+        if (!file.is_open())
+            return false;
+        text.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+        return true;
+    }
+
+    static Session &session()
+    {
+        // the window, renderer and audio device shared by the menu and every game
+        static Session shared;
+        return shared;
+    }
+
+    void reenter()
+    {
+        // takes the window back after another scene used it, e.g. the menu after a game
+        session().enter(gameName, Width, Height);
+    }
+
+    void requestQuit()
+    {
+        session().requestQuit();
+    }
+
+    bool quitRequested() const
+    {
+        return session().quitRequested();
+    }
+
+    static FontRegistry &fonts()
+    {
+        // one registry for the whole session, so every (font, size) pair is opened only once
+        return session().fonts;
+    }
+
     const char *gameName;       // this will store the name for each window
     SDL_Window *window;         // SDL_Window is a structure in the SDL library that represents a window or a graphical windowing element in a graphical user interface.
                                 // It acts as a container or an area on the screen where you can display your graphics, render images, and receive input events.
+                                // The window and the renderer belong to the session, games only borrow them.
     SDL_Renderer *renderer;     // SDL_Renderer is a structure in the SDL library that represents a rendering context.It allows to perform various rendering operations
     Mix_Music *backgroundMusic; // Mix_Music is a structure that represents a piece of music, something that can be played for an extended period of time, usually repeated.
     // backgroundMusic is a pointer used to store the background music for the game.
     TTF_Font *font = NULL, *msgfont = NULL; // TTF_Font represents a font object that can be used for rendering TrueType fonts in SDL applications.
                                             // It is a structure that encapsulates the necessary data and settings to handle font rendering operations.
+                                            // Both point into the font registry, which owns and closes them.
     int Width, Height;                      // this will control the width and height of window
+    AssetCache &assets;                     // the session's texture cache, games keep the handles they need instead of loading images again
+    TextRenderer &textRenderer;             // the session's text renderer, draws strings from glyph atlases instead of rasterizing them every frame
+    SpriteBatch &sprites;                   // the session's sprite batch, draws many sprites of one texture in one call
+    SoundEffects &sounds;                   // the session's sound effects, games ask for sounds and the loop starts them once per frame
+    Uint64 ticks;                           // simulation ticks run by runLoop() so far
+    InputRecording recording;               // of the running loop, while loopSettings().record is on
+    bool recordingInput;
+    Uint64 replayChecks, replayDivergedAt;  // checksums compared by a replay so far, and the first tick that differed
+    double interpolationAlpha;              // 0 = the frame shows the previous tick, 1 = the current one
+    double loopSeconds;                     // wall-clock time the last headless runLoop() took
+    FrameProfiler profiler;                 // phase timings of the last frames of runLoop()
+    Rng rng;                                // the game's only source of randomness, seeded by seedRng()
+    Uint64 runSeed;                         // what rng was seeded with for the current run
+
+private:
+    bool headless;
+    SnapshotBuffer<SimulationTimes> workerTimes; // totals of the worker thread, for the profiler
+    SDL_atomic_t workerStop, workerDone;         // the main thread asks the worker to stop, the worker says it has
+    Uint64 workerTickLength;
+
+    static int &instances()
+    {
+        // number of games alive at the moment, the main menu keeps one alive while a game runs
+        static int count = 0;
+        return count;
+    }
 };
 
 #endif // concluding preprocessor directive
@@ -0,0 +1,252 @@
+#ifndef ASSET_ARCHIVE_H
+#define ASSET_ARCHIVE_H
+
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX // windows.h would otherwise turn min and max into macros
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+// Layout of assets.pak, written by tools/packAssets.cpp:
+//   ArchiveHeader, entryCount ArchiveEntry records, the entry names, then the data of every entry,
+//   each one starting on an ArchiveAlignment boundary. Numbers are stored in the machine's byte order.
+enum
+{
+    ArchiveVersion = 1,
+    ArchiveAlignment = 16
+};
+
+struct ArchiveHeader
+{
+    char magic[4]; // "GMPK"
+    Uint32 version;
+    Uint32 entryCount;
+    Uint32 nameBytes; // size of the name block that follows the entry table
+};
+
+struct ArchiveEntry
+{
+    enum Kind
+    {
+        Raw = 0,   // the file exactly as it is on disk: sounds, fonts, text
+        Pixels = 1 // a decoded image, rows of `format` pixels ready for SDL_UpdateTexture
+    };
+
+    Uint32 nameOffset; // into the name block
+    Uint32 nameLength;
+    Uint32 kind;
+    Uint32 format; // SDL_PixelFormatEnum of Pixels entries
+    Uint32 width, height, pitch;
+    Uint32 reserved;
+    Uint64 offset; // from the start of the archive
+    Uint64 size;
+};
+
+// AssetArchive maps assets.pak into memory and hands out its entries without copying them.
+// Entry names are the asset paths the games use ("images/player.png", "sound/points.wav") and are matched
+// without regard to case, like the Windows file system the games were written on. A color-keyed image is
+// stored a second time under its AssetCache ID, "<path>#keyed".
+class AssetArchive
+{
+public:
+    AssetArchive() : base(nullptr), length(0)
+#ifdef _WIN32
+                     ,
+                     file(INVALID_HANDLE_VALUE), mapping(nullptr)
+#endif
+    {
+    }
+
+    ~AssetArchive()
+    {
+        close();
+    }
+
+    // returns false if there is no usable archive, the games then load every asset from its own file
+    bool open(const string &path)
+    {
+        close();
+        if (!mapFile(path))
+            return false;
+
+        const ArchiveHeader *header = static_cast<const ArchiveHeader *>(base);
+        if (length < sizeof(ArchiveHeader) || memcmp(header->magic, "GMPK", 4) != 0 || header->version != ArchiveVersion)
+        {
+            cout << "Ignoring " << path << ": not an asset archive of this version" << endl;
+            close();
+            return false;
+        }
+        size_t tableEnd = sizeof(ArchiveHeader) + size_t(header->entryCount) * sizeof(ArchiveEntry);
+        if (tableEnd + header->nameBytes > length)
+        {
+            cout << "Ignoring " << path << ": truncated" << endl;
+            close();
+            return false;
+        }
+
+        const ArchiveEntry *table = reinterpret_cast<const ArchiveEntry *>(static_cast<const char *>(base) + sizeof(ArchiveHeader));
+        const char *names = static_cast<const char *>(base) + tableEnd;
+        for (Uint32 i = 0; i < header->entryCount; i++)
+        {
+            const ArchiveEntry &entry = table[i];
+            if (entry.nameOffset + Uint64(entry.nameLength) > header->nameBytes || entry.offset + entry.size > length)
+                continue; // a damaged entry is skipped, its asset then comes from its file
+            entries[key(string(names + entry.nameOffset, entry.nameLength))] = &entry;
+        }
+        return true;
+    }
+
+    void close()
+    {
+        entries.clear();
+        unmap();
+    }
+
+    bool isOpen() const
+    {
+        return base != nullptr;
+    }
+
+    const ArchiveEntry *find(const string &name) const
+    {
+        if (entries.empty())
+            return nullptr;
+        map<string, const ArchiveEntry *>::const_iterator it = entries.find(key(name));
+        return it != entries.end() ? it->second : nullptr;
+    }
+
+    const void *data(const ArchiveEntry &entry) const
+    {
+        return static_cast<const char *>(base) + entry.offset;
+    }
+
+    SDL_RWops *openRW(const string &name) const
+    {
+        // a read-only stream over a raw entry, for Mix_LoadWAV_RW, TTF_OpenFontRW and friends
+        const ArchiveEntry *entry = find(name);
+        if (!entry || entry->kind != ArchiveEntry::Raw)
+            return nullptr;
+        return SDL_RWFromConstMem(data(*entry), int(entry->size));
+    }
+
+    SDL_Surface *surface(const string &name) const
+    {
+        // a surface that points into the mapping, SDL_FreeSurface releases it without touching the pixels
+        const ArchiveEntry *entry = find(name);
+        if (!entry || entry->kind != ArchiveEntry::Pixels)
+            return nullptr;
+        return SDL_CreateRGBSurfaceWithFormatFrom(const_cast<void *>(data(*entry)), int(entry->width), int(entry->height),
+                                                  SDL_BITSPERPIXEL(entry->format), int(entry->pitch), entry->format);
+    }
+
+    SDL_Texture *texture(SDL_Renderer *renderer, const string &name) const
+    {
+        // uploads the pixels straight from the mapping, nothing is decoded or converted
+        const ArchiveEntry *entry = find(name);
+        if (!entry || entry->kind != ArchiveEntry::Pixels)
+            return nullptr;
+        SDL_Texture *texture = SDL_CreateTexture(renderer, entry->format, SDL_TEXTUREACCESS_STATIC, int(entry->width), int(entry->height));
+        if (!texture)
+            return nullptr;
+        if (SDL_UpdateTexture(texture, nullptr, data(*entry), int(entry->pitch)) != 0)
+        {
+            SDL_DestroyTexture(texture);
+            return nullptr;
+        }
+        SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+        return texture;
+    }
+
+    static string key(const string &name)
+    {
+        string lower(name);
+        for (size_t i = 0; i < lower.size(); i++)
+            lower[i] = lower[i] == '\\' ? '/' : char(tolower((unsigned char)lower[i]));
+        return lower;
+    }
+
+private:
+    const void *base;
+    size_t length;
+    map<string, const ArchiveEntry *> entries; // lower-case name -> entry inside the mapping
+#ifdef _WIN32
+    HANDLE file, mapping;
+#endif
+
+    bool mapFile(const string &path)
+    {
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+        {
+            unmap();
+            return false;
+        }
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        base = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        length = size_t(size.QuadPart);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0)
+        {
+            void *view = mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (view != MAP_FAILED)
+            {
+                base = view;
+                length = size_t(info.st_size);
+            }
+        }
+        ::close(fd); // the mapping stays valid without the descriptor
+#endif
+        if (!base)
+        {
+            unmap();
+            return false;
+        }
+        return true;
+    }
+
+    void unmap()
+    {
+#ifdef _WIN32
+        if (base)
+            UnmapViewOfFile(base);
+        if (mapping)
+            CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE)
+            CloseHandle(file);
+        mapping = nullptr;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (base)
+            munmap(const_cast<void *>(base), length);
+#endif
+        base = nullptr;
+        length = 0;
+    }
+};
+
+#endif // ASSET_ARCHIVE_H
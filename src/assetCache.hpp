@@ -0,0 +1,118 @@
+#ifndef ASSET_CACHE_H
+#define ASSET_CACHE_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include "assetArchive.hpp"
+using namespace std;
+
+// TextureHandle is a shared handle to a cached texture. The texture is destroyed together with its last handle.
+typedef shared_ptr<SDL_Texture> TextureHandle;
+
+// AssetCache decodes every image once and hands out shared handles keyed by a stable asset ID.
+// It only keeps weak references, so a texture lives exactly as long as some game object still holds it.
+class AssetCache
+{
+public:
+    AssetCache() : renderer(nullptr), archive(nullptr), decodes(0) {}
+
+    void setRenderer(SDL_Renderer *r)
+    {
+        // textures belong to one renderer, so the cache has to know which one it uploads to
+        renderer = r;
+    }
+
+    void setArchive(const AssetArchive *a)
+    {
+        // images found in the archive are uploaded from its pre-decoded pixels instead of being decoded
+        archive = a;
+    }
+
+    // returns the texture for the image at path, decoding it only when no handle to it is alive anymore.
+    // colorKeyWhite makes white pixels transparent and is part of the asset ID, so keyed and plain versions never mix.
+    TextureHandle acquire(const string &path, bool colorKeyWhite = false)
+    {
+        string id = assetId(path, colorKeyWhite);
+        map<string, weak_ptr<SDL_Texture>>::iterator it = textures.find(id);
+        if (it != textures.end())
+        {
+            TextureHandle cached = it->second.lock();
+            if (cached)
+                return cached;
+        }
+
+        // the archive stores keyed images already keyed, under the same ID
+        SDL_Texture *texture = archive ? archive->texture(renderer, id) : nullptr;
+        if (!texture)
+        {
+            SDL_Surface *surface = IMG_Load(path.c_str());
+            if (!surface)
+            {
+                cout << "Failed to load image: " << IMG_GetError() << endl;
+                return nullptr;
+            }
+            if (colorKeyWhite)
+                SDL_SetColorKey(surface, SDL_TRUE, SDL_MapRGB(surface->format, 255, 255, 255));
+
+            texture = SDL_CreateTextureFromSurface(renderer, surface);
+            SDL_FreeSurface(surface);
+            if (!texture)
+            {
+                cout << "Failed to create texture: " << SDL_GetError() << endl;
+                return nullptr;
+            }
+            decodes++;
+        }
+
+        pruneExpired();
+        TextureHandle handle(texture, SDL_DestroyTexture);
+        textures[id] = handle;
+        return handle;
+    }
+
+    static string assetId(const string &path, bool colorKeyWhite)
+    {
+        // also the name of a keyed image in the asset archive
+        return colorKeyWhite ? path + "#keyed" : path;
+    }
+
+    int decodeCount() const
+    {
+        // number of images decoded so far, a cache hit does not count
+        return decodes;
+    }
+
+    int liveCount() const
+    {
+        // number of textures that are currently held by at least one handle
+        int live = 0;
+        for (map<string, weak_ptr<SDL_Texture>>::const_iterator it = textures.begin(); it != textures.end(); ++it)
+            if (!it->second.expired())
+                live++;
+        return live;
+    }
+
+private:
+    SDL_Renderer *renderer;
+    const AssetArchive *archive;
+    map<string, weak_ptr<SDL_Texture>> textures; // asset ID -> texture, an expired entry means the last handle was dropped
+    int decodes;
+
+    void pruneExpired()
+    {
+        // drops the entries whose textures were already released so the map does not grow over a session
+        for (map<string, weak_ptr<SDL_Texture>>::iterator it = textures.begin(); it != textures.end();)
+        {
+            if (it->second.expired())
+                it = textures.erase(it);
+            else
+                ++it;
+        }
+    }
+};
+
+#endif // ASSET_CACHE_H
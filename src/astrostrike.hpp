@@ -1,23 +1,54 @@
-#include <SDL2\SDL.h>
-#include <SDL2\SDL_image.h>
-#include <SDL2\SDL_ttf.h>
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <SDL2/SDL_ttf.h>
 #include <iostream>
 #include <vector>
 #include <string>
 #include <ctime>
 #include <unistd.h>
-#include <SDL2\SDL_mixer.h>
-#include <fstream>
+#include <SDL2/SDL_mixer.h>
 #include "abstract.hpp"
+#include "boxPool.hpp"
+#include "spatialGrid.hpp"
+#include "snapshotBuffer.hpp"
+#include "spriteAtlas.hpp"
 using namespace std;
-int hs;
 class AstroStrike : virtual public Arcade
 {
+public:
+    // "main --stress" turns AstroStrike into a load test of the engine: emitters fill the screen with thousands
+    // of projectiles and hundreds of enemies, and the frame times are reported when the run ends
+    struct StressSettings
+    {
+        bool enabled = false;
+        int enemies = 400;         // small enemies kept alive, topped up every tick
+        int largeEnemies = 40;
+        int playerEmitters = 16;   // streams of player bullets fanned out around the ship, each fires every tick
+        int enemyFirePeriod = 30;  // ticks between two shots of the same enemy
+        int maxBullets = 4096;     // pool sizes, nothing is spawned into a full pool
+        int maxEnemyShots = 4096;
+        int duration = 60;         // seconds of game time
+    };
+
+    static StressSettings &stressSettings()
+    {
+        static StressSettings settings;
+        return settings;
+    }
+
 private:
     const int screen_width = 800;
     const int screen_height = 600;
     const int GAME_DURATION = 20;
-    Mix_Chunk *bulletSound = nullptr;
+    enum
+    {
+        MaxBullets = 1,      // one bullet on screen at a time, the next shot waits until it hits or leaves
+        MaxEnemies = 20,
+        MaxLargeEnemies = 2, // large enemies come rarely as compared to small enemies
+        CellSize = 100,      // of the collision grid, a large enemy covers one cell
+        EmitterSpacing = 12  // pixels between two player emitters in stress mode
+    };
+    int bulletSound = -1; // id in the session's sound effects
     SDL_Event event;
 
     struct Position
@@ -27,45 +58,66 @@ private:
 
     struct Player
     {
-        SDL_Texture *texture;
         SDL_Rect position;
+        int prevX; // x at the previous tick, for render interpolation
     };
 
-    struct Bullet
+    // what the player asks for, read from the devices by pollInput() and acted on by handleEvents()
+    struct Controls
     {
-        SDL_Texture *texture;
-        SDL_Rect position;
-        int speed;
-        bool active;
+        bool left = false, right = false, fire = false;
+        bool leave = false; // Escape or the window was closed, stays set
     };
 
-    struct Enemy
+    // a box as render() draws it, between prevY and rect.y
+    struct Sprite
     {
-        SDL_Texture *texture;
-        SDL_Rect position;
-        int speed;
-        bool active;
+        SDL_Rect rect;
+        int prevY;
     };
 
-    struct LargeEnemy
+    // everything render() draws, copied from the game state after every tick
+    struct Scene
     {
-        SDL_Texture *texture;
-        SDL_Rect position;
-        int health;
-        int speed;
-        bool active;
+        Player player;
+        vector<Sprite> bullets, enemies, largeEnemies, enemyShots;
+        int score = 0;
+        bool displayWoah = false, displayCheckPoint = false, gameover = false;
+        Uint32 timeLeft = 0;
     };
 
+    Controls controls;              // owned by the main thread
+    SnapshotBuffer<Controls> input; // main thread to simulation
+    SnapshotBuffer<Scene> scenes;   // simulation to main thread
     Player player;
-    vector<Bullet> bullets;
-    vector<Enemy> enemies;
-    vector<LargeEnemy> largeEnemies;
+    // bullets and enemies are boxes in pools, stored array by array; they are drawn with the shared textures below
+    BoxPool bullets;      // velocity is negative, bullets fly up
+    BoxPool enemies;
+    BoxPool largeEnemies; // the only boxes whose health matters
+    BoxPool enemyShots;   // only fired in stress mode, they fly down and vanish when they hit the player
+
+    bool stress;          // stressSettings().enabled when the game was created
+    int maxEnemies;       // capacity of the enemy pool, MaxEnemies outside of stress mode
+    Uint64 playerHits;    // enemy shots that reached the player, stress mode only
+    int peakBullets, peakEnemyShots, peakEnemies;
+
+    SpatialGrid enemyGrid; // enemies are filed by pool slot, large enemies by maxEnemies + slot
+    vector<int> candidates;
+    BoxPool nearby;         // the candidates of one bullet, copied together so one kernel call tests them all
+    vector<int> nearbyIds;  // grid id of each box in nearby
+    Uint64 bruteForcePairs; // bullet/enemy pairs an all-pairs test would have made, to compare with the grid's counters
 
     int score;
     bool displayWoah;
     bool displayCheckPoint;
     bool gameover;
-    SDL_Texture *backgroundTexture = nullptr;
+    bool leftEarly; // Escape or the window was closed, the menu comes back without a game over screen
+    TextureHandle backgroundTexture;
+    SpriteAtlas atlas; // the ship, the bullets and both enemies in one texture, so a frame of them is one draw call
+    AtlasSprite playerSprite;
+    AtlasSprite bulletSprite;     // shared by every bullet and enemy shot
+    AtlasSprite enemySprite;      // shared by every spawned enemy
+    AtlasSprite largeEnemySprite; // shared by every spawned large enemy
 
     Uint32 startTime;
     Uint32 endTime;
@@ -74,59 +126,27 @@ private:
     bool initialize()
     {
 
-        startTime = SDL_GetTicks();
-        endTime = startTime + (GAME_DURATION * 1000);
+        startTime = gameTime(); // the timer runs on simulated time so it matches the game speed
+        endTime = startTime + ((stress ? stressSettings().duration : GAME_DURATION) * 1000);
 
-        font = TTF_OpenFont("ariali.ttf", 40);
+        font = fonts().get("ariali.ttf", 40);
 
         return true;
     }
 
-    SDL_Texture *loadTexture(const string &filePath)
+    TextureHandle loadTexture(const string &filePath)
     {
-        SDL_Surface *surface = IMG_Load(filePath.c_str());
-        if (!surface)
-        { // checking if the surface pointer is null indicating that the image failed to load.
-            cout << "Failed to load image: " << IMG_GetError() << endl;
-            return nullptr;
-        }
-
-        // setinng the color key as white
-        SDL_SetColorKey(surface, SDL_TRUE, SDL_MapRGB(surface->format, 255, 255, 255));
-
-        SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
-        SDL_FreeSurface(surface);
-
-        if (!texture)
-        {
-            cout << "Failed to create texture: " << SDL_GetError() << endl;
-            return nullptr;
-        }
-
-        return texture;
+        // the image is decoded only once through the shared cache, with the color key set as white
+        return assets.acquire(filePath, true);
     }
 
     bool loadMedia()
     {
-        player.texture = loadTexture("images/player.png"); // loading the  player texture
-        if (!player.texture)
-            return false;
+        backgroundMusic = loadMusic("sound/background_astro.mp3");
 
-        for (int i = 0; i < 1; ++i)
-        {
-            Bullet bullet;
-            bullet.texture = loadTexture("images/bullet.png"); // loading the bullet texture
-            if (!bullet.texture)
-                return false;
-
-            bullet.active = false;
-            bullets.push_back(bullet); // adding the bullet to the bullets vector
-        }
-
-        backgroundMusic = Mix_LoadMUS("sound/background_astro.mp3");
-
-        bulletSound = Mix_LoadWAV("sound/bullet_sound.mp3"); // loading the bullet sound effect
-        if (!bulletSound)
+        // loading the bullet sound effect; a few hits at once still sound like one, a stress run would drown in them
+        bulletSound = sounds.load("sound/bullet_sound.mp3", SoundEffects::Normal, 4);
+        if (bulletSound < 0 && !isHeadless())
         {
             cout << "Failed to load bullet sound effect: " << Mix_GetError() << endl;
             return false;
@@ -136,86 +156,83 @@ private:
         if (!backgroundTexture)
             return false;
 
-        return true;
+        // the sprites are packed at the size they are drawn, the large images are never scaled again
+        int ship = atlas.add("images/player.png", true, 100, 100);
+        int bullet = atlas.add("images/bullet.png", true, 20, 50);
+        int enemy = atlas.add("images/enemy.png", true, 50, 50);
+        int largeEnemy = atlas.add("images/large_enemy.png", true, 100, 100);
+        bool packed = atlas.build(renderer);
+        playerSprite = atlas.sprite(ship);
+        bulletSprite = atlas.sprite(bullet);
+        enemySprite = atlas.sprite(enemy);
+        largeEnemySprite = atlas.sprite(largeEnemy);
+        return packed;
     }
 
     void cleanup()
     {   // this function is responsible for freeing the
         // resources that were allocated during the execution of the game.
 
-        // the if conditions are checking if the pointer is null, if not then it means
-        // that the texture was loaded
-        if (player.texture)
-            SDL_DestroyTexture(player.texture);
-
-        for (vector<Bullet>::iterator it = bullets.begin(); it != bullets.end(); ++it)
-        {
-            if (it->texture)
-                SDL_DestroyTexture(it->texture);
-        }
-
-        for (vector<Enemy>::iterator it = enemies.begin(); it != enemies.end(); ++it)
-        {
-            if (it->texture)
-                SDL_DestroyTexture(it->texture);
-        }
-
-        for (vector<LargeEnemy>::iterator it = largeEnemies.begin(); it != largeEnemies.end(); ++it)
-        {
-            if (it->texture)
-                SDL_DestroyTexture(it->texture);
-        }
-
-        if (backgroundTexture)
-            SDL_DestroyTexture(backgroundTexture);
-
-        if (bulletSound)
-            Mix_FreeChunk(bulletSound);
+        // textures are shared handles, dropping the last one releases the texture
+        bullets.clear();
+        enemies.clear();
+        largeEnemies.clear();
+        enemyShots.clear();
+        atlas.clear();
+        backgroundTexture.reset();
     }
 
-    void handleEvents()
+    void pollInput()
     {
         // this loop continues as long as there are events to process.
         // SDL_PollEvent() gets the next event from the queue and stores it in the event variable.
         while (SDL_PollEvent(&event))
         {
-            if (event.type == SDL_QUIT) // when we click on window close button it should exit
-                exit(0);
+            if (event.type == SDL_QUIT) // when we click on window close button the whole arcade should close
+            {
+                requestQuit();
+                controls.leave = true;
+            }
             else if (event.type == SDL_KEYDOWN)
             {
                 if (event.key.keysym.sym == SDLK_ESCAPE)
                 {
-                    // when we click on esc key it should exit
-                    exit(0);
+                    // when we click on esc key the game ends and the menu comes back
+                    controls.leave = true;
                 }
             }
         }
-        // handling input from array keys
-        const Uint8 *keyboardState = SDL_GetKeyboardState(nullptr);
-        if (keyboardState[SDL_SCANCODE_LEFT])
+        // arrow keys move the ship, the space bar fires
+        const Uint8 *keys = keyboardState();
+        controls.left = keys[SDL_SCANCODE_LEFT] != 0;
+        controls.right = keys[SDL_SCANCODE_RIGHT] != 0;
+        controls.fire = keys[SDL_SCANCODE_SPACE] != 0;
+        input.draft() = controls;
+        input.publish(FrameProfiler::now());
+    }
+
+    void handleEvents()
+    {
+        // the controls of the newest pollInput(), which may run on another thread
+        input.acquire();
+        const Controls &held = input.latest();
+        if (held.leave)
+            leftEarly = true;
+        if (held.left)
         {
             if (player.position.x > 0)
                 player.position.x -= 5;
         }
-        if (keyboardState[SDL_SCANCODE_RIGHT])
+        if (held.right)
         {
             if (player.position.x < screen_width - player.position.w)
                 player.position.x += 5;
         }
-        // handling input from space bar
-        if (keyboardState[SDL_SCANCODE_SPACE])
+        if (held.fire)
         {
-            for (int i = 0; i < bullets.size(); ++i)
-            {
-                Bullet &bullet = bullets[i];
-                if (!bullet.active)
-                {
-                    bullet.position.x = player.position.x + player.position.w / 2 - bullet.position.w / 2;
-                    bullet.position.y = player.position.y;
-                    bullet.active = true;
-                    break;
-                }
-            }
+            // does nothing while every bullet is still flying
+            SDL_Rect bullet = {player.position.x + player.position.w / 2 - 20 / 2, player.position.y, 20, 50};
+            bullets.spawn(bullet, -5);
         }
     }
 
@@ -223,31 +240,15 @@ private:
     // it display game over message and fimal score
     void displayGameOverMessage()
     {
-        SDL_Surface *surface = TTF_RenderText_Solid(font, "Game Over", {255, 255, 0});
-        SDL_Texture *textTexture = SDL_CreateTextureFromSurface(renderer, surface);
-        SDL_Rect textRect;
-        textRect.x = (screen_width - surface->w) / 2;
-        textRect.y = (screen_height - surface->h) / 2;
-        textRect.w = surface->w;
-        textRect.h = surface->h;
-        SDL_RenderCopy(renderer, textTexture, nullptr, &textRect);
-
-        SDL_FreeSurface(surface);
-        SDL_DestroyTexture(textTexture);
+        int textW, textH;
+        textRenderer.measure(font, "Game Over", &textW, &textH);
+        SDL_Rect textRect = textRenderer.draw(font, "Game Over", (screen_width - textW) / 2, (screen_height - textH) / 2, {255, 255, 0, 255});
 
         // Render the score
         string scoreText = "Your Score: " + to_string(score);
-        SDL_Surface *scoreSurface = TTF_RenderText_Solid(font, scoreText.c_str(), {255, 255, 255});
-        SDL_Texture *scoreTexture = SDL_CreateTextureFromSurface(renderer, scoreSurface);
-        SDL_Rect scoreRect;
-        scoreRect.x = (screen_width - scoreSurface->w) / 2;
-        scoreRect.y = textRect.y + textRect.h + 20;
-        scoreRect.w = scoreSurface->w;
-        scoreRect.h = scoreSurface->h;
-        SDL_RenderCopy(renderer, scoreTexture, nullptr, &scoreRect);
-
-        SDL_FreeSurface(scoreSurface);
-        SDL_DestroyTexture(scoreTexture);
+        int scoreW;
+        textRenderer.measure(font, scoreText, &scoreW, nullptr);
+        textRenderer.draw(font, scoreText, (screen_width - scoreW) / 2, textRect.y + textRect.h + 20, {255, 255, 255, 255});
 
         SDL_RenderPresent(renderer);
     }
@@ -276,276 +277,391 @@ private:
     {
         SDL_Color color = {0, 200, 255, 255};
 
-        SDL_Surface *surface = TTF_RenderText_Solid(font, text.c_str(), color);
-        SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
-        SDL_Rect position = {x, y, surface->w, surface->h};
-
-        SDL_RenderCopy(renderer, texture, nullptr, &position);
-
-        SDL_DestroyTexture(texture);
-        SDL_FreeSurface(surface);
+        // glyphs come from the font's atlas, nothing is rasterized or uploaded here
+        textRenderer.draw(font, text, x, y, color);
     }
 
-    // this function is responsible for updating the game state during each frame
+    // this function is responsible for updating the game state during each tick
     void update()
     {
-        currentTime = SDL_GetTicks();
+        currentTime = gameTime();
 
         if (currentTime >= endTime)
         { // when time is over
-            SDL_Delay(3000);
             gameover = true;
             return;
         }
 
-        for (int i = 0; i < bullets.size(); ++i)
-        {
-            Bullet &bullet = bullets[i];
-            if (bullet.active)
-            {
-                bullet.position.y -= bullet.speed;
+        // remembering where everything was so render() can blend towards the new positions
+        player.prevX = player.position.x;
+        bullets.rememberPositions();
+        enemies.rememberPositions();
+        largeEnemies.rememberPositions();
 
-                if (bullet.position.y < 0)
-                {
-                    bullet.active = false;
-                }
-                else
-                {
-                    for (int j = 0; j < enemies.size(); ++j)
-                    {
-                        Enemy &enemy = enemies[j];
-                        if (enemy.active && SDL_HasIntersection(&bullet.position, &enemy.position))
-                        {
-                            bullet.active = false;
-                            enemy.active = false;
-
-                            score++;
-                            // bullet sound when bullet hits the enemy
-                            Mix_PlayChannel(-1, bulletSound, 0);
-
-                            if (score >= 10 && score % 10 == 0)
-                            {
-                                displayCheckPoint = true;
-                            }
-                            else
-                            {
-                                displayCheckPoint = false;
-                            }
-                        }
-                    }
-
-                    for (int j = 0; j < largeEnemies.size(); ++j)
-                    {
-                        LargeEnemy &largeEnemy = largeEnemies[j];
-                        if (largeEnemy.active && SDL_HasIntersection(&bullet.position, &largeEnemy.position))
-                        {
-                            bullet.active = false;
-                            largeEnemy.health--;
-                            Mix_PlayChannel(-1, bulletSound, 0);
-
-                            if (largeEnemy.health <= 0)
-                            {
-                                largeEnemy.active = false;
-                                score += 10;
-                                displayWoah = true;
-                            }
-                            else
-                            {
-                                displayWoah = false;
-                            }
-                        }
-                    }
-                }
-            }
+        fileEnemies();
+        bullets.advance();
+        for (int i = 0; i < bullets.size();)
+        {
+            if (bullets.y[i] < 0 || hitEnemy(bullets.box(i)))
+                bullets.release(i); // the slot is free for the next shot
+            else
+                i++;
         }
 
+        enemies.advance();
         for (int i = 0; i < enemies.size(); ++i)
         {
-            Enemy &enemy = enemies[i];
-            if (enemy.active)
+            if (enemies.y[i] > screen_height)
             {
-                enemy.position.y += enemy.speed;
-                if (enemy.position.y > screen_height)
-                {
-                    enemy.position.y = -(rand() % 500);
-                    enemy.position.x = rand() % (screen_width - enemy.position.w);
-                }
+                enemies.y[i] = -rng.below(500);
+                enemies.x[i] = rng.below(screen_width - enemies.w[i]);
+                enemies.prevY[i] = enemies.y[i]; // no blending across the jump back to the top
             }
         }
 
         // for large enemy(alien) its occurence is less than small enemies
+        largeEnemies.advance();
         for (int i = 0; i < largeEnemies.size(); ++i)
         {
-            LargeEnemy &largeEnemy = largeEnemies[i];
-            if (largeEnemy.active)
+            if (largeEnemies.y[i] > screen_height)
             {
-                largeEnemy.position.y += largeEnemy.speed;
-                if (largeEnemy.position.y > screen_height)
-                {
-                    largeEnemy.position.y = -(rand() % 500);
-                    largeEnemy.position.x = rand() % (screen_width - largeEnemy.position.w);
-                    largeEnemy.health = 3; // Reset health when repositioning
-                }
+                largeEnemies.y[i] = -rng.below(500);
+                largeEnemies.x[i] = rng.below(screen_width - largeEnemies.w[i]);
+                largeEnemies.prevY[i] = largeEnemies.y[i];
+                largeEnemies.health[i] = 3; // Reset health when repositioning
             }
         }
+
+        if (stress)
+            updateStress();
+        spawnEnemies();
     }
 
-    // this function is responsible for rendering the game elements on the screen.
-    void render()
+    // the emitters of stress mode: the player fires from every emitter each tick and each enemy fires once per period
+    void updateStress()
     {
-        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-        SDL_RenderClear(renderer);
-
-        SDL_RenderCopy(renderer, backgroundTexture, nullptr, nullptr);
-
-        // rendering the player's texture to the renderer,
-        //  displaying the player character on the screen
-        SDL_RenderCopy(renderer, player.texture, nullptr, &player.position);
+        const StressSettings &settings = stressSettings();
+        int center = player.position.x + player.position.w / 2;
+        for (int e = 0; e < settings.playerEmitters; e++)
+        {
+            SDL_Rect bullet = {center + (e - settings.playerEmitters / 2) * EmitterSpacing - 10, player.position.y, 20, 50};
+            bullets.spawn(bullet, -5);
+        }
 
-        for (int i = 0; i < bullets.size(); ++i)
+        enemyShots.rememberPositions();
+        enemyShots.advance();
+        for (int i = 0; i < enemyShots.size();)
         {
-            const Bullet &bullet = bullets[i];
-            if (bullet.active) // if a bullet is active its texture is rendered to the renderer
-                SDL_RenderCopy(renderer, bullet.texture, nullptr, &bullet.position);
+            if (enemyShots.y[i] > screen_height)
+                enemyShots.release(i);
+            else if (boxesOverlap(enemyShots.x[i], enemyShots.y[i], enemyShots.w[i], enemyShots.h[i], player.position))
+            {
+                playerHits++;
+                enemyShots.release(i);
+            }
+            else
+                i++;
         }
 
+        // the tick and the slot stagger the shots, so the enemies do not all fire on the same tick
+        int period = settings.enemyFirePeriod > 0 ? settings.enemyFirePeriod : 1;
         for (int i = 0; i < enemies.size(); ++i)
         {
-            const Enemy &enemy = enemies[i];
-            if (enemy.active) // same logic as above
-                SDL_RenderCopy(renderer, enemy.texture, nullptr, &enemy.position);
+            if ((ticks + enemies.slotOf(i)) % period || enemies.y[i] < 0)
+                continue;
+            SDL_Rect shot = {enemies.x[i] + enemies.w[i] / 2 - 5, enemies.y[i] + enemies.h[i], 10, 25};
+            enemyShots.spawn(shot, 6);
         }
 
+        peakBullets = max(peakBullets, bullets.size());
+        peakEnemyShots = max(peakEnemyShots, enemyShots.size());
+        peakEnemies = max(peakEnemies, enemies.size() + largeEnemies.size());
+    }
+
+    void reportStress()
+    {
+        const StressSettings &settings = stressSettings();
+        const FrameProfiler &profile = frameProfile();
+        cout << "Stress: " << settings.playerEmitters << " emitters, " << settings.enemies << " + " << settings.largeEnemies
+             << " enemies; peak " << peakBullets << " bullets, " << peakEnemyShots << " enemy shots, " << peakEnemies
+             << " enemies; " << playerHits << " hits taken" << endl;
+        cout << "  last " << profile.frameCount() << " frames: " << profile.framesPerSecond() << " fps, frame p50 "
+             << profile.percentile(50) << " ms, p95 " << profile.percentile(95) << " ms, p99 " << profile.percentile(99)
+             << " ms, update p99 " << profile.phasePercentile(FrameProfiler::Update, 99) << " ms, render p99 "
+             << profile.phasePercentile(FrameProfiler::Render, 99) << " ms" << endl;
+    }
+
+    // rebuilds the collision grid from where the enemies are this tick
+    void fileEnemies()
+    {
+        enemyGrid.clear();
+        for (int i = 0; i < enemies.size(); ++i)
+            enemyGrid.insert(enemies.slotOf(i), enemies.box(i));
         for (int i = 0; i < largeEnemies.size(); ++i)
+            enemyGrid.insert(maxEnemies + largeEnemies.slotOf(i), largeEnemies.box(i));
+    }
+
+    // returns true if the bullet hit an enemy, which is released when it dies
+    bool hitEnemy(const SDL_Rect &bullet)
+    {
+        // the enemies in the grid cells around the bullet, still alive, are tested exactly and all at once
+        candidates.clear();
+        enemyGrid.query(bullet, candidates);
+        bruteForcePairs += enemies.size() + largeEnemies.size();
+        nearby.clear();
+        nearbyIds.clear();
+        for (size_t c = 0; c < candidates.size(); ++c)
         {
-            const LargeEnemy &largeEnemy = largeEnemies[i];
-            if (largeEnemy.active) // same logic as above
-                SDL_RenderCopy(renderer, largeEnemy.texture, nullptr, &largeEnemy.position);
+            bool large = candidates[c] >= maxEnemies;
+            const BoxPool &pool = large ? largeEnemies : enemies;
+            int index = pool.indexOf(large ? candidates[c] - maxEnemies : candidates[c]);
+            if (index < 0)
+                continue; // shot down by an earlier bullet this tick
+            nearby.spawn(pool.box(index), 0);
+            nearbyIds.push_back(candidates[c]);
         }
+        int hit = nearby.firstOverlap(bullet);
+        if (hit < 0)
+            return false;
 
-        // conditions to display message on screen
-        if (gameover)
+        if (nearbyIds[hit] < maxEnemies)
+        {
+            enemies.releaseSlot(nearbyIds[hit]);
+
+            score++;
+            // bullet sound when bullet hits the enemy
+            sounds.play(bulletSound);
+
+            if (score >= 10 && score % 10 == 0)
+            {
+                displayCheckPoint = true;
+            }
+            else
+            {
+                displayCheckPoint = false;
+            }
+            return true;
+        }
+
+        int slot = nearbyIds[hit] - maxEnemies;
+        int index = largeEnemies.indexOf(slot);
+        largeEnemies.health[index]--;
+        sounds.play(bulletSound);
+
+        if (largeEnemies.health[index] <= 0)
+        {
+            largeEnemies.release(index);
+            score += 10;
+            displayWoah = true;
+        }
+        else
+        {
+            displayWoah = false;
+        }
+        return true;
+    }
+
+    // keeps the number of live enemies topped up, a full pool means there are enough
+    void spawnEnemies()
+    {
+        // one of each kind per tick, stress mode fills the pools at once; spawning into a full pool does nothing
+        do
+        {
+            SDL_Rect enemy = {rng.below(screen_width - 50), -rng.below(500), 50, 50};
+            enemies.spawn(enemy, rng.below(5) + 1);
+        } while (stress && !enemies.full());
+
+        do
+        {
+            SDL_Rect largeEnemy = {rng.below(screen_width - 100), -rng.below(500), 100, 100}; // Adjusting size
+            largeEnemies.spawn(largeEnemy, 1, 3); // Adjusting speed, Setting initial health
+        } while (stress && !largeEnemies.full());
+    }
+
+    bool isRunning()
+    {
+        return !gameover && !leftEarly;
+    }
+
+    int entityCount()
+    {
+        // of the scene on screen, the pools may be in the middle of a tick
+        const Scene &scene = scenes.latest();
+        return 1 + int(scene.bullets.size() + scene.enemies.size() + scene.largeEnemies.size() + scene.enemyShots.size());
+    }
+
+    bool publishesSnapshots()
+    {
+        return true;
+    }
+
+    Uint32 stateChecksum()
+    {
+        // the ship, the score and every live box; the pools' order of boxes is part of the state too
+        StateHash hash;
+        hash.add(player.position.x).add(score).add(playerHits);
+        const BoxPool *pools[] = {&bullets, &enemies, &largeEnemies, &enemyShots};
+        for (int p = 0; p < 4; p++)
+        {
+            int count = pools[p]->size();
+            hash.add(count);
+            if (count)
+                hash.add(&pools[p]->x[0], count * sizeof(Sint32)).add(&pools[p]->y[0], count * sizeof(Sint32)).add(&pools[p]->health[0], count * sizeof(Sint32));
+        }
+        return hash.result();
+    }
+
+    Uint64 acquireSnapshot()
+    {
+        scenes.acquire();
+        return scenes.latestStamp();
+    }
+
+    void publishSnapshot(Uint64 tickTime)
+    {
+        Scene &scene = scenes.draft();
+        scene.player = player;
+        copySprites(bullets, scene.bullets);
+        copySprites(enemies, scene.enemies);
+        copySprites(largeEnemies, scene.largeEnemies);
+        copySprites(enemyShots, scene.enemyShots);
+        scene.score = score;
+        scene.displayWoah = displayWoah;
+        scene.displayCheckPoint = displayCheckPoint;
+        scene.gameover = gameover;
+        scene.timeLeft = currentTime < endTime ? endTime - currentTime : 0;
+        scenes.publish(tickTime);
+    }
+
+    static void copySprites(const BoxPool &pool, vector<Sprite> &out)
+    {
+        // the vectors of a scene slot keep their memory, so this only allocates while the pools grow
+        out.resize(pool.size());
+        for (int i = 0; i < pool.size(); ++i)
+        {
+            out[i].rect = pool.box(i);
+            out[i].prevY = pool.prevY[i];
+        }
+    }
+
+    // this function is responsible for rendering the game elements on the screen.
+    // it only draws the newest scene, the game state itself may be changing on the simulation thread meanwhile
+    void render()
+    {
+        const Scene &scene = scenes.latest();
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+        SDL_RenderClear(renderer);
+
+        SDL_RenderCopy(renderer, backgroundTexture.get(), nullptr, nullptr);
+
+        // rendering the player's texture to the renderer,
+        //  displaying the player character on the screen
+        // every moving object is drawn between its last two tick positions so motion stays smooth above the tick rate
+        SDL_Rect playerRect = scene.player.position;
+        playerRect.x = interpolate(scene.player.prevX, scene.player.position.x);
+        sprites.draw(playerSprite, playerRect);
+
+        // bullets, enemies and enemy shots go through the sprite batch, all of them from one atlas texture;
+        // enemy shots are drawn with the bullet sprite at half size
+        drawSprites(scene.bullets, bulletSprite);
+        drawSprites(scene.enemies, enemySprite);
+        drawSprites(scene.largeEnemies, largeEnemySprite);
+        drawSprites(scene.enemyShots, bulletSprite);
+        sprites.flush(); // one call per run of sprites of the same texture, drawn before the text goes on top
+
+        // conditions to display message on screen; run() keeps the game over screen up, render() never waits
+        if (scene.gameover)
         {
-            SDL_Delay(3000);
             renderText("Game Over!", 70, 70);
         }
 
-        if (displayCheckPoint)
+        if (scene.displayCheckPoint)
         {
             renderText("CHECK POINT", 330, 200);
         }
 
-        if (displayWoah)
+        if (scene.displayWoah)
         {
             renderText("GOOD JOB!!", 330, 250);
         }
 
-        renderText("Score: " + to_string(score), 10, 10);
-        ifstream file("Score.txt");
-        int displayHS;
-        file >> displayHS;
-        renderText("HighScore: " + to_string(displayHS), 10, 30);
-        file.close();
+        renderText("Score: " + to_string(scene.score), 10, 10);
+        renderText("HighScore: " + to_string(highScore()), 10, 30); // served from memory, no file is read per frame
+        if (stress)
+            renderText("Bullets: " + to_string(scene.bullets.size()) + "  Shots: " + to_string(scene.enemyShots.size()) +
+                           "  Enemies: " + to_string(scene.enemies.size() + scene.largeEnemies.size()), 10, 50);
 
-        string timeString = "Time remaining: " + formatTime(endTime - currentTime);
+        string timeString = "Time remaining: " + formatTime(scene.timeLeft);
         renderText(timeString, 450, 10);
+    }
 
-        SDL_RenderPresent(renderer);
+    void drawSprites(const vector<Sprite> &boxes, const AtlasSprite &sprite)
+    {
+        for (size_t i = 0; i < boxes.size(); ++i)
+        {
+            SDL_Rect rect = boxes[i].rect;
+            rect.y = interpolate(boxes[i].prevY, rect.y);
+            sprites.draw(sprite, rect);
+        }
     }
 
 public:
-    AstroStrike() : Arcade("Astrostrike", 800, 600), score(0), displayWoah(false), displayCheckPoint(false) {}
+    AstroStrike() : Arcade("Astrostrike", 800, 600), stress(stressSettings().enabled), playerHits(0), peakBullets(0), peakEnemyShots(0),
+                    peakEnemies(0), bruteForcePairs(0), score(0), displayWoah(false), displayCheckPoint(false), gameover(false), leftEarly(false),
+                    atlas(&archive())
+    {
+        const StressSettings &settings = stressSettings();
+        maxEnemies = stress ? settings.enemies : MaxEnemies;
+        int maxLargeEnemies = stress ? settings.largeEnemies : MaxLargeEnemies;
+        bullets.reset(stress ? settings.maxBullets : MaxBullets);
+        enemies.reset(maxEnemies);
+        largeEnemies.reset(maxLargeEnemies);
+        enemyShots.reset(stress ? settings.maxEnemyShots : 0);
+        enemyGrid.reset(screen_width, screen_height, CellSize, maxEnemies + maxLargeEnemies);
+        nearby.reset(maxEnemies + maxLargeEnemies);
+    }
     void run()
     {
         if (!initialize())
             return;
 
-        if (!loadMedia())
+        // a headless run has no renderer or audio device, so it plays without textures and sounds
+        if (!loadMedia() && !isHeadless())
             return;
 
         player.position = {screen_width / 2 - 50, screen_height - 100, 100, 100};
+        player.prevX = player.position.x;
+        currentTime = startTime;
 
-        for (int i = 0; i < bullets.size(); ++i)
-        {
-            Bullet &bullet = bullets[i];
-            bullet.position = {0, 0, 20, 50};
-            bullet.speed = 5;
-        }
-
-        srand(time(nullptr));
+        seedRng(); // enemy spawns follow the run's seed
 
         Mix_PlayMusic(backgroundMusic, -1);
 
         displayWoah = false;       // Initializing display Woah/good job message variaible to false
         displayCheckPoint = false; // Initializing checkPoint to false
 
-        while (true)
+        runLoop(); // runs until update() notices that the time is over, or the player leaves
+        if (stress)
+            reportStress(); // also when the player left early, a stress run is often stopped by hand
+        if (leftEarly)
         {
-            handleEvents();
-            update();
-            render();
-
-            int activeEnemies = 0;
-            for (int i = 0; i < enemies.size(); ++i)
-            {
-                const Enemy &enemy = enemies[i];
-                if (enemy.active)
-                    activeEnemies++;
-            }
-
-            int activeLargeEnemies = 0;
-            for (int i = 0; i < largeEnemies.size(); ++i)
-            {
-                const LargeEnemy &largeEnemy = largeEnemies[i];
-                if (largeEnemy.active)
-                    activeLargeEnemies++;
-            }
-
-            const int MAX_ENEMIES = 20;
-            const int MAX_LARGE_ENEMIES = 2; // large enemies come rarely as compared to small enemies
-
-            if (activeEnemies < MAX_ENEMIES)
-            {
-                Enemy enemy;
-                enemy.texture = loadTexture("images/enemy.png");
-                if (!enemy.texture)
-                    return;
-
-                enemy.position = {rand() % (screen_width - 50), -(rand() % 500), 50, 50};
-                enemy.speed = rand() % 5 + 1;
-                enemy.active = true;
-                enemies.push_back(enemy);
-            }
-
-            if (activeLargeEnemies < MAX_LARGE_ENEMIES)
-            {
-                LargeEnemy largeEnemy;
-                largeEnemy.texture = loadTexture("images/large_enemy.png");
-                if (!largeEnemy.texture)
-                    return;
-
-                largeEnemy.position = {rand() % (screen_width - 100), -(rand() % 500), 100, 100}; // Adjusting size
-                largeEnemy.speed = 1;                                                             // Adjusting speed
-                largeEnemy.active = true;
-                largeEnemy.health = 3; // Setting initial health
-                largeEnemies.push_back(largeEnemy);
-            }
+            cleanup();
+            return;
+        }
+        if (!stress)
+            submitScore(score); // written to disk in the background, headless runs do not count
+        if (isHeadless())
+        {
+            const SpatialGrid::Counters &grid = enemyGrid.totalCounters();
+            cout << "Collision broad phase: " << grid.candidatePairs << " candidate pairs from " << grid.queries
+                 << " bullets, all-pairs would test " << bruteForcePairs << " (" << boxKernels().name << " kernels)" << endl;
+        }
 
-            currentTime = SDL_GetTicks();
-            if (currentTime >= endTime)
-            {
-                ifstream file("Score.txt");
-                file >> hs;
-                file.close();
-                if(hs<=score){
-                  ofstream file("Score.txt");
-                  file << score << endl;
-                  file.close();
-                }
-                displayGameOverMessage();
-                SDL_Delay(3000);
-                break;
-            }
+        // nobody watches a headless run, it ends without the game over screen and its pause
+        if (!isHeadless())
+        {
+            displayGameOverMessage();
+            SDL_Delay(3000);
         }
 
         cleanup();
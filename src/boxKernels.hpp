@@ -0,0 +1,154 @@
+#ifndef BOX_KERNELS_H
+#define BOX_KERNELS_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_cpuinfo.h>
+
+// Batch kernels over boxes stored as separate arrays of x, y, w and h (see BoxPool).
+// Every kernel has a scalar version and, on x86, SSE2 and AVX2 versions that handle 4 or 8 boxes per
+// instruction. boxKernels() picks the widest one the CPU running the game supports, once; the build
+// needs no extra compiler flags because the vector versions are compiled for their instruction set
+// one function at a time.
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define BOX_KERNELS_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h> // _BitScanForward
+#endif
+#if defined(__GNUC__) || defined(__clang__)
+#define BOX_KERNELS_TARGET(isa) __attribute__((target(isa)))
+#else
+#define BOX_KERNELS_TARGET(isa) // MSVC compiles intrinsics without being asked
+#endif
+#endif
+
+struct BoxKernels
+{
+    const char *name;
+    // position[i] += velocity[i]
+    void (*advance)(Sint32 *position, const Sint32 *velocity, int count);
+    // index of the first box overlapping the given one, or -1; boxes touching at an edge do not overlap,
+    // the same rule as SDL_HasIntersection
+    int (*firstOverlap)(const Sint32 *x, const Sint32 *y, const Sint32 *w, const Sint32 *h, int count, const SDL_Rect &box);
+};
+
+inline bool boxesOverlap(Sint32 x, Sint32 y, Sint32 w, Sint32 h, const SDL_Rect &box)
+{
+    return x < box.x + box.w && box.x < x + w && y < box.y + box.h && box.y < y + h;
+}
+
+inline void advanceScalar(Sint32 *position, const Sint32 *velocity, int count)
+{
+    for (int i = 0; i < count; i++)
+        position[i] += velocity[i];
+}
+
+inline int firstOverlapScalar(const Sint32 *x, const Sint32 *y, const Sint32 *w, const Sint32 *h, int count, const SDL_Rect &box)
+{
+    for (int i = 0; i < count; i++)
+        if (boxesOverlap(x[i], y[i], w[i], h[i], box))
+            return i;
+    return -1;
+}
+
+#ifdef BOX_KERNELS_X86
+inline int lowestSetBit(int mask)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, (unsigned long)mask);
+    return int(index);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+BOX_KERNELS_TARGET("sse2")
+inline void advanceSse2(Sint32 *position, const Sint32 *velocity, int count)
+{
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i *>(position + i));
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(velocity + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(position + i), _mm_add_epi32(p, v));
+    }
+    advanceScalar(position + i, velocity + i, count - i);
+}
+
+BOX_KERNELS_TARGET("sse2")
+inline int firstOverlapSse2(const Sint32 *x, const Sint32 *y, const Sint32 *w, const Sint32 *h, int count, const SDL_Rect &box)
+{
+    const __m128i left = _mm_set1_epi32(box.x), right = _mm_set1_epi32(box.x + box.w);
+    const __m128i top = _mm_set1_epi32(box.y), bottom = _mm_set1_epi32(box.y + box.h);
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i bx = _mm_loadu_si128(reinterpret_cast<const __m128i *>(x + i));
+        __m128i by = _mm_loadu_si128(reinterpret_cast<const __m128i *>(y + i));
+        __m128i bw = _mm_loadu_si128(reinterpret_cast<const __m128i *>(w + i));
+        __m128i bh = _mm_loadu_si128(reinterpret_cast<const __m128i *>(h + i));
+        __m128i overlap = _mm_and_si128(_mm_cmplt_epi32(bx, right), _mm_cmpgt_epi32(_mm_add_epi32(bx, bw), left));
+        overlap = _mm_and_si128(overlap, _mm_cmplt_epi32(by, bottom));
+        overlap = _mm_and_si128(overlap, _mm_cmpgt_epi32(_mm_add_epi32(by, bh), top));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(overlap)); // one bit per box
+        if (mask)
+            return i + lowestSetBit(mask);
+    }
+    int found = firstOverlapScalar(x + i, y + i, w + i, h + i, count - i, box);
+    return found < 0 ? -1 : i + found;
+}
+
+BOX_KERNELS_TARGET("avx2")
+inline void advanceAvx2(Sint32 *position, const Sint32 *velocity, int count)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(position + i));
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(velocity + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(position + i), _mm256_add_epi32(p, v));
+    }
+    advanceScalar(position + i, velocity + i, count - i);
+}
+
+BOX_KERNELS_TARGET("avx2")
+inline int firstOverlapAvx2(const Sint32 *x, const Sint32 *y, const Sint32 *w, const Sint32 *h, int count, const SDL_Rect &box)
+{
+    const __m256i left = _mm256_set1_epi32(box.x), right = _mm256_set1_epi32(box.x + box.w);
+    const __m256i top = _mm256_set1_epi32(box.y), bottom = _mm256_set1_epi32(box.y + box.h);
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i bx = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(x + i));
+        __m256i by = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(y + i));
+        __m256i bw = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(w + i));
+        __m256i bh = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(h + i));
+        // AVX2 only compares greater-than, so a < b is written b > a
+        __m256i overlap = _mm256_and_si256(_mm256_cmpgt_epi32(right, bx), _mm256_cmpgt_epi32(_mm256_add_epi32(bx, bw), left));
+        overlap = _mm256_and_si256(overlap, _mm256_cmpgt_epi32(bottom, by));
+        overlap = _mm256_and_si256(overlap, _mm256_cmpgt_epi32(_mm256_add_epi32(by, bh), top));
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(overlap));
+        if (mask)
+            return i + lowestSetBit(mask);
+    }
+    int found = firstOverlapSse2(x + i, y + i, w + i, h + i, count - i, box);
+    return found < 0 ? -1 : i + found;
+}
+#endif
+
+// the kernels for this CPU, chosen on first use
+inline const BoxKernels &boxKernels()
+{
+    static const BoxKernels scalar = {"scalar", advanceScalar, firstOverlapScalar};
+#ifdef BOX_KERNELS_X86
+    static const BoxKernels sse2 = {"SSE2", advanceSse2, firstOverlapSse2};
+    static const BoxKernels avx2 = {"AVX2", advanceAvx2, firstOverlapAvx2};
+    static const BoxKernels &chosen = SDL_HasAVX2() ? avx2 : SDL_HasSSE2() ? sse2 : scalar;
+    return chosen;
+#else
+    return scalar;
+#endif
+}
+
+#endif // BOX_KERNELS_H
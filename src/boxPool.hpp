@@ -0,0 +1,165 @@
+#ifndef BOX_POOL_H
+#define BOX_POOL_H
+
+#include <SDL2/SDL.h>
+#include <cstring>
+#include <vector>
+#include "boxKernels.hpp"
+using namespace std;
+
+// BoxPool stores up to a fixed number of moving boxes as a structure of arrays: x, y, w, h, the previous y,
+// the velocity and the health each live in an array of their own, and index i of every array is the i-th
+// live box. A pass that only moves boxes or only tests them reads the arrays it needs and nothing else,
+// and the batch kernels of boxKernels() work on them directly.
+//
+// The live boxes are packed at the front of the arrays, so a loop over the pool only visits live boxes:
+//
+//   for (int i = 0; i < pool.size();)
+//       if (dies(i)) pool.release(i); else i++;
+//
+// Releasing moves the last live box into the released index, so the order of iteration is not stable.
+// Slots are stable though: a slot number, handed out from a free list, names the same box until it is
+// released, which is what a structure built once per tick (like the collision grid) should hold on to.
+// Nothing is allocated after the pool is created, so memory stays flat however long a game runs.
+class BoxPool
+{
+public:
+    vector<Sint32> x, y, w, h;
+    vector<Sint32> prevY;    // y at the previous tick, for render interpolation
+    vector<Sint32> velocity; // added to y every tick
+    vector<Sint32> health;   // hits left, for boxes that take more than one
+
+    explicit BoxPool(int capacity = 0)
+    {
+        reset(capacity);
+    }
+
+    void reset(int capacity)
+    {
+        vector<Sint32> *arrays[] = {&x, &y, &w, &h, &prevY, &velocity, &health, &slots};
+        for (int i = 0; i < 8; i++)
+            arrays[i]->assign(capacity, 0);
+        where.assign(capacity, -1);
+        count = 0;
+        freeSlots.clear();
+        freeSlots.reserve(capacity);
+        for (int slot = capacity - 1; slot >= 0; slot--)
+            freeSlots.push_back(slot); // slot 0 is handed out first
+    }
+
+    // returns the index of the new box, or -1 when every slot is taken
+    int spawn(const SDL_Rect &box, int boxVelocity, int boxHealth = 1)
+    {
+        if (freeSlots.empty())
+            return -1;
+        int slot = freeSlots.back();
+        freeSlots.pop_back();
+        int index = count++;
+        x[index] = box.x;
+        y[index] = box.y;
+        w[index] = box.w;
+        h[index] = box.h;
+        prevY[index] = box.y;
+        velocity[index] = boxVelocity;
+        health[index] = boxHealth;
+        slots[index] = slot;
+        where[slot] = index;
+        return index;
+    }
+
+    void release(int index)
+    {
+        int slot = slots[index];
+        freeSlots.push_back(slot);
+        where[slot] = -1;
+        int last = --count;
+        if (index == last)
+            return;
+        x[index] = x[last];
+        y[index] = y[last];
+        w[index] = w[last];
+        h[index] = h[last];
+        prevY[index] = prevY[last];
+        velocity[index] = velocity[last];
+        health[index] = health[last];
+        slots[index] = slots[last];
+        where[slots[index]] = index;
+    }
+
+    void releaseSlot(int slot)
+    {
+        release(where[slot]);
+    }
+
+    void clear()
+    {
+        // releases every live box, in time proportional to their number
+        for (int index = count - 1; index >= 0; index--)
+        {
+            freeSlots.push_back(slots[index]);
+            where[slots[index]] = -1;
+        }
+        count = 0;
+    }
+
+    int slotOf(int index) const
+    {
+        return slots[index];
+    }
+
+    // index of a live slot's box, -1 while the slot is free
+    int indexOf(int slot) const
+    {
+        return where[slot];
+    }
+
+    SDL_Rect box(int index) const
+    {
+        SDL_Rect rect = {x[index], y[index], w[index], h[index]};
+        return rect;
+    }
+
+    int size() const
+    {
+        return count;
+    }
+
+    int capacity() const
+    {
+        return int(slots.size());
+    }
+
+    bool full() const
+    {
+        return freeSlots.empty();
+    }
+
+    void rememberPositions()
+    {
+        if (count)
+            memcpy(&prevY[0], &y[0], count * sizeof(Sint32));
+    }
+
+    void advance()
+    {
+        // y += velocity for every live box, a vector of them per instruction
+        if (count)
+            boxKernels().advance(&y[0], &velocity[0], count);
+    }
+
+    // index of the first live box overlapping the rectangle, or -1
+    int firstOverlap(const SDL_Rect &rect) const
+    {
+        if (!count)
+            return -1;
+        return boxKernels().firstOverlap(&x[0], &y[0], &w[0], &h[0], count, rect);
+    }
+
+private:
+    vector<Sint32> slots;  // index -> slot of the box
+    vector<int> where;     // slot -> index of its box, -1 while the slot is free
+    vector<int> freeSlots; // slots that spawn() can hand out, used as a stack
+    int count;
+};
+
+#endif // BOX_POOL_H
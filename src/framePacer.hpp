@@ -0,0 +1,61 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <SDL2/SDL.h>
+
+// FramePacer holds a loop to a fixed number of frames per second.
+// It sleeps with SDL_Delay while the next frame is far away and spins on the performance counter
+// for the last couple of milliseconds, because SDL_Delay alone can oversleep by a millisecond or more.
+class FramePacer
+{
+public:
+    enum
+    {
+        SpinMargin = 2 // milliseconds before the deadline where sleeping stops and spinning starts
+    };
+
+    FramePacer(int framesPerSecond = 60) : frequency(SDL_GetPerformanceFrequency()), period(0)
+    {
+        setRate(framesPerSecond);
+        next = SDL_GetPerformanceCounter();
+    }
+
+    void setRate(int framesPerSecond)
+    {
+        // 0 means no limit, the loop then only waits for vsync (if it is on)
+        period = framesPerSecond > 0 ? frequency / framesPerSecond : 0;
+    }
+
+    void wait()
+    {
+        // blocks until the current frame has used up its time slot
+        if (!period)
+            return;
+
+        next += period;
+        Uint64 now = SDL_GetPerformanceCounter();
+        if (now >= next)
+        {
+            // the frame ran late; if it is more than a whole frame behind, start counting again from now
+            // instead of rushing through several frames to catch up
+            if (now - next > period)
+                next = now;
+            return;
+        }
+
+        while (now < next)
+        {
+            Uint64 remaining = (next - now) * 1000 / frequency;
+            if (remaining > SpinMargin)
+                SDL_Delay(Uint32(remaining - SpinMargin));
+            now = SDL_GetPerformanceCounter();
+        }
+    }
+
+private:
+    Uint64 frequency; // performance counter ticks per second
+    Uint64 period;    // performance counter ticks per frame
+    Uint64 next;      // when the current frame is due to end
+};
+
+#endif // FRAME_PACER_H
@@ -0,0 +1,231 @@
+#ifndef FRAME_PROFILER_H
+#define FRAME_PROFILER_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "textRenderer.hpp"
+using namespace std;
+
+// FrameProfiler times the phases of every frame of the game loop with the performance counter.
+// The last HistorySize frames (or as many as it is created with) are kept in a ring buffer; they feed the on-screen overlay and the CSV dump.
+class FrameProfiler
+{
+public:
+    enum Phase
+    {
+        Events,
+        Update,
+        Render,
+        Present,
+        PhaseCount
+    };
+
+    enum
+    {
+        HistorySize = 600 // ten seconds at 60 frames per second
+    };
+
+    struct Frame
+    {
+        Uint64 phase[PhaseCount]; // performance counter ticks spent in each phase
+        Uint64 total;             // whole frame, including the time the pacer waited
+        int ticks;                // simulation ticks run in this frame
+        int entities;             // entities alive at the end of the frame, as the game reports them
+        int drawCalls;            // SDL_RenderGeometry calls of the sprite batch
+        int sprites;              // sprites drawn through the batch
+    };
+
+    FrameProfiler(int capacity = HistorySize) : frequency(SDL_GetPerformanceFrequency()), capacity(capacity > 0 ? capacity : 1), next(0), count(0), recorded(0), frameStart(0)
+    {
+        current = Frame();
+        history.resize(this->capacity);
+    }
+
+    static Uint64 now()
+    {
+        return SDL_GetPerformanceCounter();
+    }
+
+    void beginFrame()
+    {
+        frameStart = now();
+        current = Frame();
+    }
+
+    void add(Phase phase, Uint64 elapsed)
+    {
+        // a phase can run several times per frame (one events/update pair per tick), so its times add up
+        current.phase[phase] += elapsed;
+    }
+
+    void countTick()
+    {
+        current.ticks++;
+    }
+
+    void endFrame(int entities, int drawCalls = 0, int sprites = 0)
+    {
+        current.total = now() - frameStart;
+        current.entities = entities;
+        current.drawCalls = drawCalls;
+        current.sprites = sprites;
+        history[next] = current;
+        next = (next + 1) % capacity;
+        if (count < capacity)
+            count++;
+        recorded++;
+    }
+
+    int frameCount() const
+    {
+        // frames currently held in the ring buffer
+        return count;
+    }
+
+    const Frame &frame(int age) const
+    {
+        // age 0 is the newest frame
+        return history[(next + capacity - 1 - age) % capacity];
+    }
+
+    double milliseconds(Uint64 counts) const
+    {
+        return counts * 1000.0 / frequency;
+    }
+
+    double framesPerSecond() const
+    {
+        double seconds = totalSeconds();
+        return seconds > 0 ? count / seconds : 0;
+    }
+
+    double percentile(double p) const
+    {
+        // frame time in milliseconds that p percent of the buffered frames stay under
+        vector<Uint64> totals(count);
+        for (int i = 0; i < count; i++)
+            totals[i] = history[i].total;
+        return percentileOf(totals, p);
+    }
+
+    double phasePercentile(Phase phase, double p) const
+    {
+        // the same for the time one phase took per frame
+        vector<Uint64> times(count);
+        for (int i = 0; i < count; i++)
+            times[i] = history[i].phase[phase];
+        return percentileOf(times, p);
+    }
+
+    double totalSeconds() const
+    {
+        // wall-clock time of the buffered frames
+        Uint64 total = 0;
+        for (int i = 0; i < count; i++)
+            total += history[i].total;
+        return double(total) / frequency;
+    }
+
+    double averagePhase(Phase phase) const
+    {
+        if (!count)
+            return 0;
+        Uint64 total = 0;
+        for (int i = 0; i < count; i++)
+            total += history[i].phase[phase];
+        return milliseconds(total) / count;
+    }
+
+    // draws the stats in the top-left corner; budgetMs is the frame time a full-width bar stands for
+    void drawOverlay(SDL_Renderer *renderer, TextRenderer &text, TTF_Font *font, double budgetMs)
+    {
+        static const char *names[PhaseCount] = {"events", "update", "render", "present"};
+        static const SDL_Color colors[PhaseCount] = {{90, 170, 255, 255}, {120, 220, 120, 255}, {250, 200, 70, 255}, {240, 100, 100, 255}};
+        const SDL_Color white = {255, 255, 255, 255};
+        const int barWidth = 160, lineHeight = 18, left = 8, top = 8;
+
+        SDL_BlendMode blendMode;
+        Uint8 r, g, b, a;
+        SDL_GetRenderDrawBlendMode(renderer, &blendMode);
+        SDL_GetRenderDrawColor(renderer, &r, &g, &b, &a);
+
+        SDL_Rect panel = {0, 0, 260, top * 2 + lineHeight * (PhaseCount + 3)};
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 170);
+        SDL_RenderFillRect(renderer, &panel);
+
+        char line[96];
+        snprintf(line, sizeof(line), "%.0f fps  p50 %.2f ms  p99 %.2f ms", framesPerSecond(), percentile(50), percentile(99));
+        text.draw(font, line, left, top, white);
+        snprintf(line, sizeof(line), "entities %d  ticks/frame %d", count ? frame(0).entities : 0, count ? frame(0).ticks : 0);
+        text.draw(font, line, left, top + lineHeight, white);
+        snprintf(line, sizeof(line), "draw calls %d  sprites %d", count ? frame(0).drawCalls : 0, count ? frame(0).sprites : 0);
+        text.draw(font, line, left, top + lineHeight * 2, white);
+
+        for (int p = 0; p < PhaseCount; p++)
+        {
+            double ms = averagePhase(Phase(p));
+            int y = top + lineHeight * (p + 3);
+            snprintf(line, sizeof(line), "%-7s %5.2f", names[p], ms);
+            text.draw(font, line, left, y, white);
+
+            int w = budgetMs > 0 ? int(ms / budgetMs * barWidth) : 0;
+            SDL_Rect bar = {left + 88, y + 4, min(w, barWidth), lineHeight - 8};
+            SDL_SetRenderDrawColor(renderer, colors[p].r, colors[p].g, colors[p].b, 255);
+            SDL_RenderFillRect(renderer, &bar);
+        }
+
+        SDL_SetRenderDrawBlendMode(renderer, blendMode);
+        SDL_SetRenderDrawColor(renderer, r, g, b, a);
+    }
+
+    // writes the buffered frames, oldest first, with every time in milliseconds
+    bool writeCsv(const string &path) const
+    {
+        if (!count)
+            return true;
+        ofstream file(path);
+        if (!file.is_open())
+        {
+            cout << "Failed to write profile: " << path << endl;
+            return false;
+        }
+        file << "frame,events_ms,update_ms,render_ms,present_ms,total_ms,ticks,entities,draw_calls,sprites\n";
+        for (int age = count - 1; age >= 0; age--)
+        {
+            const Frame &f = frame(age);
+            file << recorded - 1 - age;
+            for (int p = 0; p < PhaseCount; p++)
+                file << ',' << milliseconds(f.phase[p]);
+            file << ',' << milliseconds(f.total) << ',' << f.ticks << ',' << f.entities << ',' << f.drawCalls << ',' << f.sprites << '\n';
+        }
+        return true;
+    }
+
+private:
+    Uint64 frequency;
+    int capacity;
+    vector<Frame> history; // ring buffer, next is where the following frame goes
+    int next;
+    int count;
+    Uint64 recorded; // frames recorded since the profiler was created
+    Uint64 frameStart;
+    Frame current;
+
+    double percentileOf(vector<Uint64> &values, double p) const
+    {
+        if (values.empty())
+            return 0;
+        size_t rank = size_t(p / 100.0 * (values.size() - 1) + 0.5);
+        nth_element(values.begin(), values.begin() + rank, values.end());
+        return milliseconds(values[rank]);
+    }
+};
+
+#endif // FRAME_PROFILER_H
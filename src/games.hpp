@@ -0,0 +1,32 @@
+#ifndef GAMES_H
+#define GAMES_H
+
+#include <string>
+#include "puzzle.hpp"
+#include "pingpong.hpp"
+#include "tetris.hpp"
+#include "astrostrike.hpp"
+#include "spookyChase.hpp"
+using namespace std;
+
+// builds one game by its name, as given to "main --headless" and the benchmark; nullptr for an unknown name
+inline Arcade *createGame(const string &name)
+{
+    if (name == "astrostrike")
+        return new AstroStrike;
+    if (name == "spookychase")
+        return new SpookyChase;
+    if (name == "mindmaze")
+        return new MindMaze;
+    if (name == "pingpong")
+        return new PingPong;
+    if (name == "tetris")
+        return createTetris();
+    if (name == "tetristall")
+        return new TallTetris("TetrisTall");
+    if (name == "tetriswide")
+        return new WideTetris("TetrisWide");
+    return nullptr;
+}
+
+#endif // GAMES_H
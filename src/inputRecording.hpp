@@ -0,0 +1,202 @@
+#ifndef INPUT_RECORDING_H
+#define INPUT_RECORDING_H
+
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "inputScript.hpp"
+using namespace std;
+
+// StateHash folds the parts of a game's state into one 32-bit number (FNV-1a), to compare two runs tick by tick.
+// Only add plain numbers and arrays of them; the padding inside a struct is not part of the state.
+class StateHash
+{
+public:
+    StateHash() : value(2166136261u) {}
+
+    StateHash &add(const void *data, size_t size)
+    {
+        const Uint8 *bytes = static_cast<const Uint8 *>(data);
+        for (size_t i = 0; i < size; i++)
+        {
+            value ^= bytes[i];
+            value *= 16777619u;
+        }
+        return *this;
+    }
+
+    template <typename T>
+    StateHash &add(const T &number)
+    {
+        return add(&number, sizeof(number));
+    }
+
+    Uint32 result() const
+    {
+        return value;
+    }
+
+private:
+    Uint32 value;
+};
+
+// InputRecording is everything needed to play a session of a game again: the game, the seed of its Rng, the
+// keys pressed on every tick, and a checksum of the game state every checkInterval ticks to notice where a
+// replay stops matching the original (a bug, a change to the game, or something that is not deterministic).
+//
+// The file is small: after a header, each key event is the number of ticks since the previous one and the
+// scancode with its flags, both as varints (7 bits per byte, the high bit says another byte follows), so a
+// typical event takes two or three bytes. The checksums follow as plain 32-bit numbers, they do not compress.
+class InputRecording
+{
+public:
+    enum
+    {
+        Version = 1
+    };
+
+    string game;              // the name the game gives Arcade, e.g. "Tetris"
+    Uint64 seed = 0;          // what the game's Rng was seeded with
+    Uint32 tickRate = 60;     // of the recorded run; ticks, not seconds, are what has to match
+    Uint32 checkInterval = 1; // ticks between two checksums
+    Uint64 ticks = 0;         // ticks the recorded run lasted
+    vector<InputScript::KeyEvent> events;
+    vector<Uint32> checksums; // the i-th one is taken after tick (i + 1) * checkInterval
+
+    void addKey(Uint64 tick, SDL_Scancode key, bool pressed, bool repeat)
+    {
+        InputScript::KeyEvent event = {tick, key, pressed, repeat && pressed};
+        events.push_back(event);
+    }
+
+    // the keys of the recording as a script for a headless run
+    void fillScript(InputScript &script) const
+    {
+        for (size_t i = 0; i < events.size(); i++)
+            script.add(events[i].tick, events[i].key, events[i].pressed, events[i].repeat);
+    }
+
+    bool save(const string &path) const
+    {
+        vector<Uint8> out;
+        out.insert(out.end(), magic(), magic() + 4);
+        putVarint(out, Version);
+        putVarint(out, game.size());
+        out.insert(out.end(), game.begin(), game.end());
+        putVarint(out, seed);
+        putVarint(out, tickRate);
+        putVarint(out, checkInterval);
+        putVarint(out, ticks);
+
+        putVarint(out, events.size());
+        Uint64 previous = 0;
+        for (size_t i = 0; i < events.size(); i++)
+        {
+            // events are recorded in tick order, so the deltas are never negative
+            const InputScript::KeyEvent &event = events[i];
+            putVarint(out, event.tick - previous);
+            putVarint(out, (Uint64(event.key) << 2) | (event.pressed ? 2 : 0) | (event.repeat ? 1 : 0));
+            previous = event.tick;
+        }
+
+        putVarint(out, checksums.size());
+        for (size_t i = 0; i < checksums.size(); i++)
+            for (int shift = 0; shift < 32; shift += 8)
+                out.push_back(Uint8(checksums[i] >> shift));
+
+        ofstream file(path, ios::binary);
+        if (!file.write(reinterpret_cast<const char *>(out.data()), out.size()))
+        {
+            cout << "Failed to write recording: " << path << endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool load(const string &path)
+    {
+        ifstream file(path, ios::binary);
+        if (!file.is_open())
+        {
+            cout << "Failed to open recording: " << path << endl;
+            return false;
+        }
+        vector<Uint8> in((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+        size_t at = 0;
+        Uint64 version = 0, nameLength = 0, rate = 0, interval = 0, count = 0;
+        if (in.size() < 4 || !equal(magic(), magic() + 4, in.begin()))
+            return fail(path, "not a recording");
+        at = 4;
+        if (!getVarint(in, at, version) || version != Version)
+            return fail(path, "unsupported version");
+        if (!getVarint(in, at, nameLength) || nameLength > in.size() - at)
+            return fail(path, "truncated header");
+        game.assign(in.begin() + at, in.begin() + at + nameLength);
+        at += nameLength;
+        if (!getVarint(in, at, seed) || !getVarint(in, at, rate) || !getVarint(in, at, interval) || !getVarint(in, at, ticks))
+            return fail(path, "truncated header");
+        tickRate = Uint32(rate);
+        checkInterval = interval > 0 ? Uint32(interval) : 1;
+
+        events.clear();
+        if (!getVarint(in, at, count))
+            return fail(path, "truncated events");
+        Uint64 tick = 0;
+        for (Uint64 i = 0; i < count; i++)
+        {
+            Uint64 delta, packed;
+            if (!getVarint(in, at, delta) || !getVarint(in, at, packed) || (packed >> 2) >= SDL_NUM_SCANCODES)
+                return fail(path, "truncated events");
+            tick += delta;
+            addKey(tick, SDL_Scancode(packed >> 2), (packed & 2) != 0, (packed & 1) != 0);
+        }
+
+        checksums.clear();
+        if (!getVarint(in, at, count) || count > (in.size() - at) / 4)
+            return fail(path, "truncated checksums");
+        for (Uint64 i = 0; i < count; i++, at += 4)
+            checksums.push_back(Uint32(in[at]) | Uint32(in[at + 1]) << 8 | Uint32(in[at + 2]) << 16 | Uint32(in[at + 3]) << 24);
+        return true;
+    }
+
+private:
+    static const char *magic()
+    {
+        return "ARCR";
+    }
+
+    static void putVarint(vector<Uint8> &out, Uint64 value)
+    {
+        while (value >= 0x80)
+        {
+            out.push_back(Uint8(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(Uint8(value));
+    }
+
+    static bool getVarint(const vector<Uint8> &in, size_t &at, Uint64 &value)
+    {
+        value = 0;
+        for (int shift = 0; shift < 64 && at < in.size(); shift += 7)
+        {
+            Uint8 byte = in[at++];
+            value |= Uint64(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+                return true;
+        }
+        return false;
+    }
+
+    static bool fail(const string &path, const char *reason)
+    {
+        cout << "Failed to read recording " << path << ": " << reason << endl;
+        return false;
+    }
+};
+
+#endif // INPUT_RECORDING_H
@@ -0,0 +1,144 @@
+#ifndef INPUT_SCRIPT_H
+#define INPUT_SCRIPT_H
+
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "rng.hpp"
+using namespace std;
+
+// InputScript replaces the keyboard when a game runs headless.
+// It holds key presses and releases stamped with the simulation tick they happen on; every tick the due ones
+// update the scripted keyboard state and are pushed to the SDL event queue as key events, so a game's
+// handleEvents() sees them exactly as it would see real keys. Recorded sessions (see InputRecording) also
+// carry the key repeats of a held key, which games like Tetris act on.
+class InputScript
+{
+public:
+    struct KeyEvent
+    {
+        Uint64 tick;
+        SDL_Scancode key;
+        bool pressed;
+        bool repeat; // a key down sent again while the key is held
+    };
+
+    InputScript() : next(0)
+    {
+        memset(keys, 0, sizeof(keys));
+    }
+
+    void add(Uint64 tick, SDL_Scancode key, bool pressed, bool repeat = false)
+    {
+        KeyEvent event = {tick, key, pressed, repeat && pressed};
+        events.push_back(event);
+        sorted = false;
+    }
+
+    // reads a script with one event per line: "<tick> <key name> down|up", e.g. "120 Space down".
+    // Key names are the ones SDL_GetScancodeFromName understands, lines starting with # are comments.
+    bool load(const string &path)
+    {
+        ifstream file(path);
+        if (!file.is_open())
+        {
+            cout << "Failed to open input script: " << path << endl;
+            return false;
+        }
+        string line;
+        int lineNumber = 0;
+        while (getline(file, line))
+        {
+            lineNumber++;
+            if (line.empty() || line[0] == '#')
+                continue;
+            istringstream fields(line);
+            Uint64 tick;
+            string name, state;
+            if (!(fields >> tick >> name >> state))
+            {
+                cout << path << ":" << lineNumber << ": expected \"<tick> <key> down|up\"" << endl;
+                return false;
+            }
+            SDL_Scancode key = SDL_GetScancodeFromName(name.c_str());
+            if (key == SDL_SCANCODE_UNKNOWN)
+            {
+                cout << path << ":" << lineNumber << ": unknown key " << name << endl;
+                return false;
+            }
+            add(tick, key, state == "down");
+        }
+        return true;
+    }
+
+    // fills the script with random presses and releases of the given keys over the first `ticks` ticks,
+    // the same seed always gives the same input
+    void synthesize(Uint64 seed, Uint64 ticks, const vector<SDL_Scancode> &keySet)
+    {
+        Rng rng(seed);
+        for (Uint64 tick = 0; tick < ticks && !keySet.empty();)
+        {
+            SDL_Scancode key = keySet[rng.below(int(keySet.size()))];
+            Uint64 release = tick + rng.range(1, 30); // ticks a key stays down
+            add(tick, key, true);
+            add(release, key, false);
+            tick += rng.range(1, 21); // ticks until the next press
+        }
+    }
+
+    // applies every event that is due at this tick
+    void apply(Uint64 tick)
+    {
+        if (!sorted)
+        {
+            stable_sort(events.begin(), events.end(), earlier);
+            sorted = true;
+        }
+        for (; next < events.size() && events[next].tick <= tick; next++)
+        {
+            const KeyEvent &scripted = events[next];
+            if ((keys[scripted.key] != 0) == scripted.pressed && !(scripted.repeat && keys[scripted.key]))
+                continue; // the key is already in that state, a real keyboard would not report it again
+
+            keys[scripted.key] = scripted.pressed ? 1 : 0;
+            SDL_Event event;
+            memset(&event, 0, sizeof(event));
+            event.type = scripted.pressed ? SDL_KEYDOWN : SDL_KEYUP;
+            event.key.state = scripted.pressed ? SDL_PRESSED : SDL_RELEASED;
+            event.key.repeat = scripted.repeat ? 1 : 0;
+            event.key.keysym.scancode = scripted.key;
+            event.key.keysym.sym = keycodeOf(scripted.key);
+            SDL_PushEvent(&event);
+        }
+    }
+
+    const Uint8 *keyboardState() const
+    {
+        // laid out like SDL_GetKeyboardState(), indexed by scancode
+        return keys;
+    }
+
+private:
+    vector<KeyEvent> events;
+    size_t next; // first event that has not been applied yet
+    bool sorted = true;
+    Uint8 keys[SDL_NUM_SCANCODES];
+
+    static bool earlier(const KeyEvent &a, const KeyEvent &b)
+    {
+        return a.tick < b.tick;
+    }
+
+    static SDL_Keycode keycodeOf(SDL_Scancode key)
+    {
+        // SDL_GetKeyFromScancode() needs the video subsystem for its keymap, so the default US layout is used
+        return SDL_GetKeyFromName(SDL_GetScancodeName(key));
+    }
+};
+
+#endif // INPUT_SCRIPT_H
@@ -1,9 +1,152 @@
 #include<iostream>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include "mainMenu.hpp"
+
 int main(int argc, char *argv[])
 {
+    // optional frame pacing for the cabinet's display, e.g. "main --fps 144" or "main --fps 0 --vsync"
+    // the simulation always ticks at Arcade::loopSettings().tickRate, so the games play at the same speed either way
+    // "main --seed 42" plays every game with the same random sequence each time, for profiling and comparing builds
+    // "main --profile" starts with the frame profiler overlay shown (F3 toggles it), "--no-profile-csv" skips the CSV dump
+    // "main --headless tetris 20000 --input keys.txt" runs one game without a window or audio and reports its speed
+    // "main --stress 800 32" plays AstroStrike as a load test with 800 enemies and 32 bullet emitters (both optional)
+    // "main --single-thread" keeps every game's simulation on the main thread, between the frames, instead of on a worker
+    // "main --record 10" writes replay-<game>.rec for every game played, with a state checksum every 10 ticks (default 1)
+    // "main --replay replay-Tetris.rec" plays a recording again headless, as fast as it goes, and reports where it diverges
+    // "main --bot 4" lets a bot play Tetris, searching on 4 threads (default one per core); with "--headless tetris" it
+    // reports how many placements it scores per second; "--bot-weights -0.51,0.76,-0.36,-0.18" tunes its heuristic
+    // (height, lines, holes, bumpiness)
+    // "main --board wide" plays Tetris on 24 columns instead of 10, "--board tall" on 26 lines instead of 20
+    // "main --das 133 --arr 0" sets how long a Tetris arrow key is held before it repeats and how fast it repeats,
+    // in milliseconds (default 167 and 33, 0 moves the piece straight to the wall)
+    string headlessGame, inputPath, replayPath;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--vsync") == 0)
+            Arcade::loopSettings().vsync = true;
+        else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc)
+            Arcade::loopSettings().frameRate = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            Arcade::loopSettings().seed = strtoull(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--profile") == 0)
+            Arcade::loopSettings().profilerOverlay = true;
+        else if (strcmp(argv[i], "--no-profile-csv") == 0)
+            Arcade::loopSettings().profilerCsv = false;
+        else if (strcmp(argv[i], "--single-thread") == 0)
+            Arcade::loopSettings().simulationThread = false;
+        else if (strcmp(argv[i], "--record") == 0)
+        {
+            Arcade::loopSettings().record = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-')
+                Arcade::loopSettings().checkInterval = Uint32(atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+            replayPath = argv[++i];
+        else if (strcmp(argv[i], "--headless") == 0 && i + 1 < argc)
+        {
+            headlessGame = argv[++i];
+            if (i + 1 < argc && argv[i + 1][0] != '-')
+                Arcade::headlessSettings().maxTicks = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--stress") == 0)
+        {
+            AstroStrike::StressSettings &stress = AstroStrike::stressSettings();
+            stress.enabled = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-')
+                stress.enemies = atoi(argv[++i]);
+            if (i + 1 < argc && argv[i + 1][0] != '-')
+                stress.playerEmitters = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--bot") == 0)
+        {
+            TetrisSettings::current().bot = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-')
+                TetrisSettings::current().botThreads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--bot-weights") == 0 && i + 1 < argc)
+        {
+            TetrisBotWeights &weights = TetrisSettings::current().botWeights;
+            if (sscanf(argv[++i], "%lf,%lf,%lf,%lf", &weights.height, &weights.lines, &weights.holes, &weights.bumpiness) != 4)
+            {
+                cout << "--bot-weights takes four numbers: height,lines,holes,bumpiness" << endl;
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--board") == 0 && i + 1 < argc)
+        {
+            i++;
+            if (strcmp(argv[i], "tall") == 0)
+                TetrisSettings::current().board = TetrisSettings::Tall;
+            else if (strcmp(argv[i], "wide") == 0)
+                TetrisSettings::current().board = TetrisSettings::Wide;
+            else
+                TetrisSettings::current().board = TetrisSettings::Classic;
+        }
+        else if (strcmp(argv[i], "--das") == 0 && i + 1 < argc)
+            TetrisSettings::current().autoShiftDelay = Uint32(max(0, atoi(argv[++i])));
+        else if (strcmp(argv[i], "--arr") == 0 && i + 1 < argc)
+            TetrisSettings::current().autoRepeatRate = Uint32(max(0, atoi(argv[++i])));
+        else if (strcmp(argv[i], "--input") == 0 && i + 1 < argc)
+            inputPath = argv[++i];
+    }
+
+    InputRecording replay;
+    if (!replayPath.empty())
+    {
+        // the recording says which game, with which seed, for how long and at which tick rate
+        if (!replay.load(replayPath))
+            return 1;
+        headlessGame = replay.game;
+        transform(headlessGame.begin(), headlessGame.end(), headlessGame.begin(), ::tolower);
+        Arcade::loopSettings().seed = replay.seed;
+        Arcade::loopSettings().tickRate = int(replay.tickRate);
+        Arcade::headlessSettings().maxTicks = replay.ticks;
+        Arcade::headlessSettings().replay = &replay;
+    }
+
+    if (!headlessGame.empty())
+    {
+        Arcade::HeadlessSettings &headless = Arcade::headlessSettings();
+        headless.enabled = true;
+        if (!headless.maxTicks)
+            headless.maxTicks = 60000; // a bit over 16 minutes of game time at 60 ticks per second
+
+        InputScript input;
+        if (!replayPath.empty())
+            replay.fillScript(input);
+        else if (!inputPath.empty())
+        {
+            if (!input.load(inputPath))
+                return 1;
+        }
+        else
+        {
+            // without a script every game gets the same pseudo-random presses of the keys the games use
+            SDL_Scancode keySet[] = {SDL_SCANCODE_LEFT, SDL_SCANCODE_RIGHT, SDL_SCANCODE_UP, SDL_SCANCODE_DOWN,
+                                     SDL_SCANCODE_SPACE, SDL_SCANCODE_W, SDL_SCANCODE_S};
+            input.synthesize(1234, headless.maxTicks, vector<SDL_Scancode>(keySet, keySet + 7));
+        }
+        headless.input = &input;
+
+        Arcade *game = createGame(headlessGame);
+        if (!game)
+        {
+            cout << "Unknown game: " << headlessGame << " (astrostrike, spookychase, mindmaze, pingpong, tetris, tetristall or tetriswide)" << endl;
+            return 1;
+        }
+        game->run();
+        cout << headlessGame << ": " << game->tickCount() << " ticks, " << game->updatesPerSecond() << " updates/s, seed " << game->rngSeed() << endl;
+        bool diverged = game->replayDiverged();
+        delete game;
+        return diverged ? 2 : 0;
+    }
+
     Arcade *mainMenu = new MainMenu;
     mainMenu->run();
     delete mainMenu;
     return 0;
-}
\ No newline at end of file
+}
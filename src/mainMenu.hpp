@@ -5,11 +5,7 @@
 #include <iostream>
 #include <vector>
 #include <string>
-#include "puzzle.hpp"
-#include "pingpong.hpp"
-#include "tetris.hpp"
-#include "astrostrike.hpp"
-#include "spookyChase.hpp"
+#include "games.hpp"
 using namespace std;
 
 const int SCREEN_WIDTH = 800;
@@ -19,16 +15,21 @@ const int SCREEN_HEIGHT = 700;
 struct MenuOption
 {
     SDL_Rect rect;
-    SDL_Texture *texture;
+    AtlasSprite sprite;
 
-    MenuOption(SDL_Rect rect, SDL_Texture *texture) : rect(rect), texture(texture) {}
+    MenuOption(SDL_Rect rect, AtlasSprite sprite) : rect(rect), sprite(sprite) {}
 };
 
-class MainMenu : public MindMaze, public PingPong, public Tetris, public SpookyChase, public AstroStrike
+// the menu is a scene of the session like the games, it starts them one at a time and takes the window back when they end
+class MainMenu : virtual public Arcade
 {
 private:
-    SDL_Texture *backgroundTexture, *textTexture;
-    TTF_Font *font = nullptr;
+    TextureHandle backgroundTexture;
+    SpriteAtlas atlas;         // every menu tile in one texture, so a menu screen is one draw call
+    int gameTiles[5];          // atlas ids of the game tiles, in menu order
+    int submenuTiles[3];       // play, how to play and back
+    AtlasSprite backSprite;    // "back" button shown with the instructions
+    SDL_Texture *textTexture;
     SDL_Color fontColor = {255, 255, 255,255};
     SDL_Rect textRect;
     vector<MenuOption *> gameOptions;
@@ -41,8 +42,8 @@ private:
     bool initialize()
     {
         backgroundTexture = LoadTexture("images/mainBg.png", renderer);
-        font = TTF_OpenFont("Oswald-Bold.ttf", 20);
-        if (!backgroundTexture || !font)
+        font = fonts().get("Oswald-Bold.ttf", 20);
+        if (!backgroundTexture || !packTiles() || !font)
         {
             cout << "Failed to initialize." << endl;
             return false;
@@ -51,27 +52,48 @@ private:
         return true;
     }
 
+    bool packTiles()
+    {
+        // the tiles are packed at the size they are shown, the background stays a texture of its own
+        const char *gameTilePaths[] = {
+            "images/astrostrike.png",
+            "images/spookychase.png",
+            "images/mindmaze.png",
+            "images/pingpong.png",
+            "images/tetris.png"};
+        const char *submenuTilePaths[] = {
+            "images/play.png",
+            "images/how to play.png",
+            "images/back.png"};
+
+        atlas.clear();
+        for (int i = 0; i < 5; ++i)
+            gameTiles[i] = atlas.add(gameTilePaths[i], false, 150, 150);
+        for (int i = 0; i < 3; ++i)
+            submenuTiles[i] = atlas.add(submenuTilePaths[i], false, 200, 150);
+        bool packed = atlas.build(renderer);
+        backSprite = atlas.sprite(submenuTiles[2]);
+        return packed;
+    }
+
     void cleanup()
     {
-        SDL_DestroyTexture(backgroundTexture);
+        // the background is a shared handle and the atlas owns its pages, both go before the renderer does
+        backgroundTexture.reset();
+        atlas.clear();
         for (MenuOption *option : gameOptions)
         {
-            SDL_DestroyTexture(option->texture);
             delete option;
         }
         gameOptions.clear();
 
         for (MenuOption *option : submenuOptions)
         {
-            SDL_DestroyTexture(option->texture);
             delete option;
         }
         submenuOptions.clear();
 
-        SDL_DestroyRenderer(renderer);
-        SDL_DestroyWindow(window);
-        TTF_CloseFont(font);
-        SDL_DestroyTexture(textTexture);
+        SDL_DestroyTexture(textTexture); // the renderer, the window and the font are released by Arcade
     }
 
     void renderText(const string &text)
@@ -100,13 +122,6 @@ private:
 
     void createGameOptions()
     {
-        const char *gameOptionPaths[] = {
-            "images/astrostrike.png",
-            "images/spookychase.png",
-            "images/mindmaze.png",
-            "images/pingpong.png",
-            "images/tetris.png"};
-
         const int gameOptionWidth = 150;
         const int gameOptionHeight = 150;
         const int gameOptionPadding = 20;
@@ -142,61 +157,53 @@ private:
             }
 
             SDL_Rect rect{optionX, optionY, gameOptionWidth, gameOptionHeight};
-            SDL_Texture *texture = LoadTexture(gameOptionPaths[i], renderer);
-            gameOptions.push_back(new MenuOption(rect, texture));
+            gameOptions.push_back(new MenuOption(rect, atlas.sprite(gameTiles[i])));
         }
     }
     void createSubMenuOptions()
     {
+        for (MenuOption *option : submenuOptions)
+        {
+            delete option;
+        }
         submenuOptions.clear();
 
-        const char *submenuOptionPaths[] = {
-            "images/play.png",
-            "images/how to play.png",
-            "images/back.png"};
-
         const int submenuOptionWidth = 200;
         const int submenuOptionHeight = 150;
         const int submenuOptionPadding = 30;
 
-        for (int i = 0; i < 4; ++i)
+        for (int i = 0; i < 3; ++i)
         {
             int optionX = 100 + i * (submenuOptionWidth + submenuOptionPadding);
             SDL_Rect rect{optionX, 400, submenuOptionWidth, submenuOptionHeight};
-            SDL_Texture *texture = LoadTexture(submenuOptionPaths[i], renderer);
-            submenuOptions.push_back(new MenuOption(rect, texture));
+            submenuOptions.push_back(new MenuOption(rect, atlas.sprite(submenuTiles[i])));
         }
     }
 
     void renderMainMenu()
     {
-        SDL_RenderCopy(renderer, backgroundTexture, nullptr, nullptr);
+        SDL_RenderCopy(renderer, backgroundTexture.get(), nullptr, nullptr);
 
         for (MenuOption *option : gameOptions)
         {
-            SDL_RenderCopy(renderer, option->texture, nullptr, &option->rect);
+            sprites.draw(option->sprite, option->rect);
         }
-
-        SDL_RenderPresent(renderer);
     }
     void renderSubMenu()
     {
-        SDL_RenderCopy(renderer, backgroundTexture, nullptr, nullptr);
+        SDL_RenderCopy(renderer, backgroundTexture.get(), nullptr, nullptr);
         if (!displayText)
         {
             for (MenuOption *option : submenuOptions)
             {
-                SDL_RenderCopy(renderer, option->texture, nullptr, &option->rect);
+                sprites.draw(option->sprite, option->rect);
             }
         }
         else
         {
-            SDL_Texture *imageTexture = LoadTexture("images/back.png", renderer);
             SDL_Rect imageRect = {600, 580, 200, 150};
-            if (imageTexture)
-            {
-                SDL_RenderCopy(renderer, imageTexture, nullptr, &imageRect);
-            }
+            sprites.draw(backSprite, imageRect);
+            sprites.flush(); // the instructions are drawn on top of the tiles
             SDL_RenderCopy(renderer, textTexture, nullptr, &textRect);
             SDL_Event e;
             while (SDL_PollEvent(&e))
@@ -221,7 +228,29 @@ private:
                 }
             }
         }
-        SDL_RenderPresent(renderer);
+    }
+    void update()
+    {
+        // the menu has no simulation, it only reacts to clicks
+    }
+    void render()
+    {
+        if (currentSubMenu == 0)
+        {
+            renderMainMenu();
+        }
+        else
+        {
+            renderSubMenu();
+        }
+    }
+    bool isRunning()
+    {
+        return !quit && !quitRequested(); // closing the window inside a game closes the menu too
+    }
+    int entityCount()
+    {
+        return int(gameOptions.size() + submenuOptions.size());
     }
     void handleMainMenuEvents(SDL_Event &event)
     {
@@ -316,10 +345,14 @@ private:
         }
         else if (currentSubMenu == 5)
         {
-            Tetris tetris;
-            tetris.run();
+            Arcade *tetris = createTetris(); // on the board size main picked
+            tetris->run();
+            delete tetris;
             gameRunning = true; // Set the gameRunning flag to true
         }
+        // the game is gone, the menu takes the window back; clicks and keys meant for the game are dropped
+        reenter();
+        SDL_FlushEvents(SDL_KEYDOWN, SDL_MOUSEWHEEL);
     }
     void handleSubMenuInstructionsClick()
     {
@@ -345,16 +378,12 @@ private:
             fileName = "textFiles/tetris.txt";
         }
 
-        ifstream file(fileName);
-        if (file.is_open())
+        string text;
+        if (loadText(fileName, text)) // from the asset archive when there is one
         {
-            string text;
-            string line;
-            while (getline(file, line))
-            {
-                text += line + "\n"; // Add bullet point and line break
-            }
-            file.close();
+            text.erase(remove(text.begin(), text.end(), '\r'), text.end());
+            if (!text.empty() && text[text.size() - 1] != '\n')
+                text += "\n";
             renderText(text);
         }
         else
@@ -362,19 +391,16 @@ private:
             cout << "Failed to open file: " << fileName << endl;
         }
     }
-    SDL_Texture *LoadTexture(const char *filename, SDL_Renderer *renderer)
+    TextureHandle LoadTexture(const char *filename, SDL_Renderer * /*renderer*/)
     {
-        SDL_Surface *surface = IMG_Load(filename);
-        SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
-        SDL_FreeSurface(surface);
-
-        return texture;
+        // menu tiles are shared through the cache, so rebuilding the sub-menu does not decode them again
+        return assets.acquire(filename);
     }
 
 public:
-    MainMenu() : Arcade("MainMenu", SCREEN_WIDTH, SCREEN_HEIGHT), currentSubMenu(0), gameRunning(false), quit(false)
+    MainMenu() : Arcade("MainMenu", SCREEN_WIDTH, SCREEN_HEIGHT), atlas(&archive()), currentSubMenu(0), gameRunning(false), quit(false)
     {
-        createGameOptions();
+        // the options are created by initialize(), once their tiles are packed
     }
     void run()
     {
@@ -385,19 +411,22 @@ public:
             return;
         }
         SDL_Event event;
-        while (!quit)
+        FramePacer pacer(loopSettings().frameRate); // the menu only waits for clicks, so it should not keep a core busy
+        while (isRunning())
         {
             SDL_RenderClear(renderer);
+            render();
+            sprites.flush(); // the menu runs its own loop, so it flushes the batch itself
+            SDL_RenderPresent(renderer);
             if (currentSubMenu == 0)
             {
-                renderMainMenu();
                 handleMainMenuEvents(event);
             }
             else
             {
-                renderSubMenu();
                 handleSubMenuEvents(event);
             }
+            pacer.wait();
         }
         cleanup();
     }
@@ -1,4 +1,5 @@
 #include "abstract.hpp"
+#include "snapshotBuffer.hpp"
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
 #include <SDL2/SDL_ttf.h>
@@ -25,7 +26,7 @@ SDL_Color textColor = {0, 192, 249, 255}; // SDL_Color is a structure that repre
 class PingPong : virtual public Arcade
 {
 public:
-    PingPong() : Arcade("PingPong"), ballTexture(nullptr), ballVelX(BALL_SPEED), ballVelY(BALL_SPEED), lScore(0), rScore(0), running(false), scoreTexture(nullptr), paddleHitSound(nullptr) {}
+    PingPong() : Arcade("PingPong"), atlas(&archive()), backgroundTexture(nullptr), paddleHitSound(-1), ballVelX(BALL_SPEED), ballVelY(BALL_SPEED), lScore(0), rScore(0), running(false) {}
     // default constructor
     void run() // controls the running of the game
     {
@@ -36,26 +37,31 @@ public:
             return;
         }
 
-        loadMedia();
+        // a headless run may have an offscreen renderer, but never an audio device; a missing asset goes back to the menu
+        if ((!isHeadless() || renderer) && !loadMedia())
+        {
+            cleanup();
+            return;
+        }
 
         ball.x = Width / 2 - BALL_SIZE / 2;
         ball.y = Height / 2 - BALL_SIZE / 2;
         ball.w = BALL_SIZE;
         ball.h = BALL_SIZE;
-        SDL_RenderCopy(renderer, ballTexture, NULL, &ball);
-        SDL_RenderCopy(renderer, lScoreTexture, NULL, &lScoreRect);
-        SDL_RenderCopy(renderer, rScoreTexture, NULL, &rScoreRect);
+        prevBall = ball;
+        sprites.draw(ballSprite, ball);
+        sprites.flush(); // the scores are text, drawn after the ball
+        renderScores(lScore, rScore);
         SDL_RenderPresent(renderer);
 
         Mix_PlayMusic(backgroundMusic, -1);
 
-        while (running)
-        {
-            handleEvents();
-            update();
-            render();
-        }
-        SDL_Delay(3000);
+        runLoop(); // polls input, updates and renders at a fixed tick rate until a player reaches the max score
+        bool finished = lScore >= maxScore || rScore >= maxScore;
+        if (finished)
+            submitScore(abs(lScore - rScore)); // the winner's margin, it is a two player game
+        if (finished && !isHeadless())
+            SDL_Delay(3000); // keeping the game over message on screen
         cleanup();
     }
 
@@ -64,29 +70,41 @@ private:
     {
         SDL_Rect rect;        // SDL_Rect is a structure that represents a rectangle. It is commonly used to define the position and dimensions of objects
                               // or areas within a GUI or when working with graphics and rendering in SDL-based applications.
-        SDL_Texture *texture; // SDL_Texture is a structure in the SDL library that represents an optimized texture for rendering on the GPU(Graphics Processing Unit).
     };
-    SDL_Texture *ballTexture;
-    SDL_Texture *lScoreTexture;
-    SDL_Texture *rScoreTexture;
+    struct Controls // what the players ask for, read from the devices by pollInput() and acted on by handleEvents()
+    {
+        bool leftUp = false, leftDown = false, rightUp = false, rightDown = false;
+        bool leave = false; // Escape or the window was closed, stays set
+    };
+    struct Scene // everything render() draws, copied from the game state after every tick
+    {
+        SDL_Rect ball, prevBall, lPaddle, rPaddle;
+        int prevLPaddleY, prevRPaddleY;
+        int lScore = 0, rScore = 0;
+        bool over = false; // a player reached maxScore
+    };
+    Controls controls;              // owned by the main thread
+    SnapshotBuffer<Controls> input; // main thread to simulation
+    SnapshotBuffer<Scene> scenes;   // simulation to main thread
+    SpriteAtlas atlas; // the ball and both paddles come from one texture, so they are one draw call
+    AtlasSprite ballSprite, paddleSprite;
     SDL_Texture *backgroundTexture;
 
-    Mix_Chunk *paddleHitSound; // The Mix_Chunk is a structure that represents a sound effect.
-    // paddleHitSound is a pointer used to store the sound effect when the paddle hits ball.
+    int paddleHitSound; // id of the sound effect when the paddle hits ball, in the session's sound effects
     SDL_Rect ball;
-    Paddle lPaddle; // creating a left paddle using Paddle structure
-    Paddle rPaddle; // creating a right paddle using Paddle structure
+    SDL_Rect prevBall; // ball position at the previous tick, render() draws the ball in between for smooth motion
+    Paddle lPaddle{}; // creating a left paddle using Paddle structure
+    Paddle rPaddle{}; // creating a right paddle using Paddle structure
+    int prevLPaddleY, prevRPaddleY; // paddle positions at the previous tick
     int ballVelX;
     int ballVelY;
     int lScore;   // variable for storing left player's score
     int rScore;   // variable for storing right player's score
     bool running; // variable for checking the state of game(running or not)
-    SDL_Texture *scoreTexture;
-    SDL_Rect lScoreRect;
-    SDL_Rect rScoreRect;
     bool initialize() // This method initializes SDL and other necessary components.
     {
-        font = TTF_OpenFont("Oswald-Bold.ttf", 75); // loading the Oswald-Bold font file and setting its size
+        font = fonts().get("Oswald-Bold.ttf", 75);    // getting the Oswald-Bold font in the size of the scores from the shared font registry
+        msgfont = fonts().get("Oswald-Bold.ttf", 35); // the game over message font is looked up once here instead of being opened every frame
 
         lPaddle.rect.x = 20;                             // specifying the horizontal position of the paddle on the game screen.
         lPaddle.rect.y = Height / 2 - PADDLE_HEIGHT / 2; // specifying the vertical position of the paddle on the game screen.
@@ -97,195 +115,124 @@ private:
         rPaddle.rect.y = Height / 2 - PADDLE_HEIGHT / 2;
         rPaddle.rect.w = PADDLE_WIDTH;
         rPaddle.rect.h = PADDLE_HEIGHT;
+        prevLPaddleY = lPaddle.rect.y;
+        prevRPaddleY = rPaddle.rect.y;
 
         return true;
     }
-    void handleEvents() // This method handles SDL events, such as keyboard input.
+    void pollInput() // This method reads SDL events and the keyboard on the main thread, the simulation may run on another one.
     {
         SDL_Event event;              // SDL_Event is a structure used to represent an event that occurs in program, such as a key press, mouse movement, window event, or user-defined event.
         while (SDL_PollEvent(&event)) // SDL_PollEvent() is a function used to check for pending events in the event queue and retrieve the next event, if available.
                                       //  The parameter is a pointer to an SDL_Event structure where the retrieved event will be stored.
         {
-            if (event.type == SDL_QUIT) // If a quit event((e.g. by clicking the close button) is detected, the program is exited.
+            if (event.type == SDL_QUIT) // If a quit event((e.g. by clicking the close button) is detected, the game ends and the arcade closes.
             {
-                cleanup();
-                exit(0);
+                requestQuit();
+                controls.leave = true;
             }
         }
 
-        const Uint8 *currentKeyStates = SDL_GetKeyboardState(NULL); // SDL_GetKeyboardState is a function used to get the current state of the keyboard.(Uint8 = unsigned 8 bit integer)
+        const Uint8 *currentKeyStates = keyboardState(); // keyboardState() gets the current state of the keyboard like SDL_GetKeyboardState, or the scripted one in headless runs.(Uint8 = unsigned 8 bit integer)
         // The function returns a pointer to an array of Uint8 values, where each element represents the state of a specific key on the keyboard.
         // Scan codes are unique identifiers assigned to each key on a keyboard, regardless of the physical layout or keyboard language.
-        if (currentKeyStates[SDL_SCANCODE_W] && lPaddle.rect.y > 0)
+        controls.leftUp = currentKeyStates[SDL_SCANCODE_W] != 0;
+        controls.leftDown = currentKeyStates[SDL_SCANCODE_S] != 0;
+        controls.rightUp = currentKeyStates[SDL_SCANCODE_UP] != 0;
+        controls.rightDown = currentKeyStates[SDL_SCANCODE_DOWN] != 0;
+        if (currentKeyStates[SDL_SCANCODE_ESCAPE]) // Escape leaves the game, back to the menu
+        {
+            controls.leave = true;
+        }
+        input.draft() = controls;
+        input.publish(FrameProfiler::now());
+    }
+    void handleEvents() // This method moves the paddles by the controls of the newest pollInput().
+    {
+        input.acquire();
+        const Controls &held = input.latest();
+        if (held.leave)
+        {
+            running = false;
+        }
+
+        prevLPaddleY = lPaddle.rect.y; // remembering the paddle positions before this tick moves them
+        prevRPaddleY = rPaddle.rect.y;
+
+        if (held.leftUp && lPaddle.rect.y > 0)
         {
             lPaddle.rect.y -= PADDLE_SPEED;
         }
-        if (currentKeyStates[SDL_SCANCODE_S] && lPaddle.rect.y + lPaddle.rect.h < Height)
+        if (held.leftDown && lPaddle.rect.y + lPaddle.rect.h < Height)
         {
             lPaddle.rect.y += PADDLE_SPEED;
         }
-        if (currentKeyStates[SDL_SCANCODE_UP] && rPaddle.rect.y > 0)
+        if (held.rightUp && rPaddle.rect.y > 0)
         {
             rPaddle.rect.y -= PADDLE_SPEED;
         }
-        if (currentKeyStates[SDL_SCANCODE_DOWN] && rPaddle.rect.y + rPaddle.rect.h < Height)
+        if (held.rightDown && rPaddle.rect.y + rPaddle.rect.h < Height)
         {
             rPaddle.rect.y += PADDLE_SPEED;
         }
-        if (currentKeyStates[SDL_SCANCODE_ESCAPE])
-        {
-            cleanup();
-            exit(0);
-        }
     }
     void cleanup() // This method releases the memory resources used by SDL and other components.
     {
-        if (ballTexture)
+        atlas.clear();
+        if (backgroundTexture)
         {
-            SDL_DestroyTexture(ballTexture);
-            ballTexture = nullptr;
-        }
-        if (lPaddle.texture)
-        {
-            SDL_DestroyTexture(lPaddle.texture);
-            lPaddle.texture = nullptr;
-        }
-        if (rPaddle.texture)
-        {
-            SDL_DestroyTexture(rPaddle.texture);
-            rPaddle.texture = nullptr;
-        }
-        if (lScoreTexture)
-        {
-            SDL_DestroyTexture(lScoreTexture);
-            lScoreTexture = nullptr;
-        }
-
-        if (rScoreTexture)
-        {
-            SDL_DestroyTexture(rScoreTexture);
-            rScoreTexture = nullptr;
-        }
-
-        if (paddleHitSound)
-        {
-            Mix_FreeChunk(paddleHitSound);
-            paddleHitSound = nullptr;
+            SDL_DestroyTexture(backgroundTexture); // the renderer outlives the game, so everything it made has to go
+            backgroundTexture = nullptr;
         }
     }
 
-    void loadMedia() // This method loads images, fonts, and sounds.
+    bool loadMedia() // This method loads images, fonts, and sounds, false if one of them is missing.
     {
-        SDL_Surface *ballSurface = IMG_Load(BALL_IMAGE_PATH.c_str()); // SDL_Surface is a structure in the SDL library that represents a two-dimensional image surface.
-        // ballSurface is a pointer used to store the result of loading the ball image using IMG_Load.
-        if (!ballSurface)
-        {
-            cout << "Failed to load ball image: " << IMG_GetError() << endl;
-            cleanup();
-            exit(1);
-        }
-
-        ballTexture = SDL_CreateTextureFromSurface(renderer, ballSurface); // SDL_CreateTextureFromSurface allows you to convert an SDL surface into a texture
-        // creating texture of ball
-
-        SDL_FreeSurface(ballSurface); // SDL_FreeSurface is a function used to free the memory allocated for an SDL_Surface object.
-        // freeing the memory because after creating texture, surface is no longer needed
-        if (!ballTexture)
-        {
-            cout << "Failed to create ball texture: " << SDL_GetError() << endl;
-            cleanup();
-            exit(1);
-        }
-        ball.w = ballSurface->w; // setting the width of the ball based on the width of the loaded image surface (ballSurface).
-        ball.h = ballSurface->h; // setting height of the ball based on the height of the loaded image surface (ballSurface).
-        SDL_Surface *paddleSurface = IMG_Load(PADDLE_IMAGE_PATH.c_str());
-        // paddleSurface is used to store the result of loading the paddle image using IMG_Load.
-        if (!paddleSurface)
-        {
-            cout << "Failed to load paddle image: " << IMG_GetError() << endl;
-            return;
-        }
-
-        lPaddle.texture = SDL_CreateTextureFromSurface(renderer, paddleSurface); // creating texture of left paddle
-        if (!lPaddle.texture)
-        {
-            cout << "Failed to create left paddle texture: " << SDL_GetError() << endl;
-            SDL_FreeSurface(paddleSurface);
-            return;
-        }
-
-        rPaddle.texture = SDL_CreateTextureFromSurface(renderer, paddleSurface); // creating texture of right paddle
-        if (!rPaddle.texture)
-        {
-            cout << "Failed to create right paddle texture: " << SDL_GetError() << endl;
-            SDL_FreeSurface(paddleSurface);
-            return;
-        }
-
-        SDL_FreeSurface(paddleSurface);
-
-        SDL_Surface *lScoreSurface = TTF_RenderText_Solid(font, "0", textColor);
-        if (!lScoreSurface)
+        // the ball and the paddle share one atlas texture, packed at the size they are drawn
+        int ballId = atlas.add(BALL_IMAGE_PATH, false, BALL_SIZE, BALL_SIZE);
+        int paddleId = atlas.add(PADDLE_IMAGE_PATH, false, PADDLE_WIDTH, PADDLE_HEIGHT);
+        bool packed = atlas.build(renderer);
+        ballSprite = atlas.sprite(ballId);
+        paddleSprite = atlas.sprite(paddleId);
+        if (!packed || !ballSprite.texture || !paddleSprite.texture)
         {
-            cout << "Failed to render left score text: " << TTF_GetError() << endl;
-            cleanup();
-            exit(1);
-        }
-        SDL_Surface *rScoreSurface = TTF_RenderText_Solid(font, "0", textColor);
-        if (!rScoreSurface)
-        {
-            cout << "Failed to render right score text: " << TTF_GetError() << endl;
-            cleanup();
-            exit(1);
+            cout << "Failed to pack the ball and paddle images: " << SDL_GetError() << endl;
+            return false;
         }
 
-        lScoreTexture = SDL_CreateTextureFromSurface(renderer, lScoreSurface);
-        if (!lScoreTexture)
+        if (!font || !msgfont)
         {
-            cout << "Failed to create left score texture: " << SDL_GetError() << endl;
-            cleanup();
-            exit(1);
+            cout << "Failed to load score font: " << TTF_GetError() << endl;
+            return false;
         }
 
-        rScoreTexture = SDL_CreateTextureFromSurface(renderer, rScoreSurface);
-        if (!rScoreTexture)
-        {
-            cout << "Failed to create right score texture: " << SDL_GetError() << endl;
-            cleanup();
-            exit(1);
-        }
-
-        SDL_FreeSurface(lScoreSurface);
-        SDL_FreeSurface(rScoreSurface);
-
-        SDL_Surface *backgroundSurface = IMG_Load("images/pongBg.jpg");
+        SDL_Surface *backgroundSurface = loadSurface("images/pongBg.jpg");
         if (!backgroundSurface)
         {
             cout << "Failed to load background image: " << IMG_GetError() << endl;
-            cleanup();
-            exit(1);
+            return false;
         }
         backgroundTexture = SDL_CreateTextureFromSurface(renderer, backgroundSurface);
         SDL_FreeSurface(backgroundSurface);
         if (!backgroundTexture)
         {
             cout << "Failed to create background texture: " << SDL_GetError() << endl;
-            cleanup();
-            exit(1);
+            return false;
         }
-        backgroundMusic = Mix_LoadMUS("sound/ping-pong.mp3"); // Mix_LoadMUS() is used to load a supported audio format into a music object.
+        backgroundMusic = loadMusic("sound/ping-pong.mp3"); // Mix_LoadMUS() (through loadMusic) is used to load a supported audio format into a music object.
 
-        paddleHitSound = Mix_LoadWAV("sound/paddle-hit.mp3"); // Mix_LoadMUS() is used to load a supported audio format into a chunk.
-        if (!paddleHitSound)
+        paddleHitSound = sounds.load("sound/paddle-hit.mp3", SoundEffects::High, 2); // decoded once per session, the ball can only hit one paddle at a time anyway
+        if (paddleHitSound < 0 && !isHeadless())
         {
             cout << "Failed to load paddle hit sound: " << Mix_GetError() << endl;
-            cleanup();
-            exit(1);
+            return false;
         }
+        return true;
     }
 
     void update() // This method updates the game state, such as moving the ball and paddles, checking collisions, and updating scores.
     {
+        prevBall = ball;
         ball.x += ballVelX;
         ball.y += ballVelY;
         // moving the ball by adding the current velocity
@@ -304,17 +251,15 @@ private:
         // checks if ball collides with left paddle and if it does, the horizontal velocity is reversed, and hitting sound is played
         {
             ballVelX = -ballVelX;
-            Mix_PlayChannel(-1, paddleHitSound, 0); // Mix_PlayChannel() is used to play an audio chunk on a specific channel.
-            // 1st parameter is "channel". Here its value (-1) allows SDL_mixer choose an available channel automatically.
-            // 2nd parameter is pointer to "Mix_Chunk". Here its value (paddleHitSound) tells whichb sound is to be played.
-            // 3rd parameter is "loops". Here its value (0) means the sound will be played once.
+            sounds.play(paddleHitSound); // sounds.play() asks for the sound, the game loop gives it a channel (a voice) once per frame.
+            // Hits asked for in the same frame are played as one, and a sound never has more voices than it was loaded with.
         }
 
         if (ball.x + BALL_SIZE >= rPaddle.rect.x && ball.y + BALL_SIZE >= rPaddle.rect.y && ball.y <= rPaddle.rect.y + rPaddle.rect.h)
         // checks if ball collides with right paddle and if it does, the horizontal velocity is reversed, and hitting sound is played
         {
             ballVelX = -ballVelX;
-            Mix_PlayChannel(-1, paddleHitSound, 0);
+            sounds.play(paddleHitSound);
         }
 
         if (ball.x <= 0) // checks if ball has reached left edge, if it does the right player's score is incremented and ball is resetted to it's original position
@@ -322,6 +267,7 @@ private:
             rScore++;
             ball.x = Width / 2 - BALL_SIZE / 2;
             ball.y = Height / 2 - BALL_SIZE / 2;
+            prevBall = ball; // the ball jumps back to the center, it should not be drawn sliding there
             ballVelX = BALL_SPEED;
             ballVelY = BALL_SPEED;
         }
@@ -331,53 +277,85 @@ private:
             lScore++;
             ball.x = Width / 2 - BALL_SIZE / 2;
             ball.y = Height / 2 - BALL_SIZE / 2;
+            prevBall = ball;
             ballVelX = -BALL_SPEED;
             ballVelY = -BALL_SPEED;
         }
+    }
 
-        string lScoreStr = to_string(lScore);
-        string rScoreStr = to_string(rScore);
-        // converting scores from integer to string to render on screen
+    bool isRunning()
+    {
+        return running;
+    }
+
+    bool publishesSnapshots()
+    {
+        return true;
+    }
 
-        SDL_Surface *lScoreSurface = TTF_RenderText_Solid(font, lScoreStr.c_str(), textColor);
-        SDL_Surface *rScoreSurface = TTF_RenderText_Solid(font, rScoreStr.c_str(), textColor);
-        // creating surfaces to render the left and right scores as text
-        // TTF_RenderText_Solid() is used to render solid text onto an SDL surface. It takes the specified text, font, and color as input and produces a rendered SDL surface containing the rendered text.
+    void publishSnapshot(Uint64 tickTime) // This method copies what render() draws, after every tick.
+    {
+        Scene &scene = scenes.draft();
+        scene.ball = ball;
+        scene.prevBall = prevBall;
+        scene.lPaddle = lPaddle.rect;
+        scene.rPaddle = rPaddle.rect;
+        scene.prevLPaddleY = prevLPaddleY;
+        scene.prevRPaddleY = prevRPaddleY;
+        scene.lScore = lScore;
+        scene.rScore = rScore;
+        scene.over = lScore >= maxScore || rScore >= maxScore; // leaving with Escape is not the end of the match
+        scenes.publish(tickTime);
+    }
 
-        SDL_DestroyTexture(lScoreTexture);
-        SDL_DestroyTexture(rScoreTexture);
-        // destroying the existing textures for rendering the left and right scores.
+    Uint64 acquireSnapshot()
+    {
+        scenes.acquire();
+        return scenes.latestStamp();
+    }
 
-        lScoreTexture = SDL_CreateTextureFromSurface(renderer, lScoreSurface);
-        rScoreTexture = SDL_CreateTextureFromSurface(renderer, rScoreSurface);
-        // creating new textures from the updated score surfaces
+    Uint32 stateChecksum() // This method hashes the ball, the paddles and the scores, to compare a replay with its recording.
+    {
+        StateHash hash;
+        hash.add(ball.x).add(ball.y).add(ballVelX).add(ballVelY);
+        hash.add(lPaddle.rect.y).add(rPaddle.rect.y).add(lScore).add(rScore);
+        return hash.result();
+    }
 
-        SDL_FreeSurface(lScoreSurface);
-        SDL_FreeSurface(rScoreSurface);
-        // freeing the memory used by the score surfaces after the textures have been created
+    void renderScores(int left, int right) // This method draws both scores from the glyph atlas of the score font, so no text is rasterized per frame.
+    {
+        string lScoreStr = to_string(left);
+        string rScoreStr = to_string(right);
+        // converting scores from integer to string to render on screen
+
+        int lScoreW;
+        textRenderer.measure(font, lScoreStr, &lScoreW, NULL);
+        textRenderer.draw(font, lScoreStr, (Width / 2) - SCORE_X_OFFSET - lScoreW, SCORE_Y_OFFSET, textColor); // rendering left player's score on screen
+        textRenderer.draw(font, rScoreStr, (Width / 2) + SCORE_X_OFFSET, SCORE_Y_OFFSET, textColor);           // rendering right player's score on screen
     }
 
-    void render() // This method renders the game on the screen, including paddles, ball, scores, and a game won / game over message.
+    void render() // This method renders the newest scene on the screen, including paddles, ball, scores, and a game won / game over message.
     {
+        const Scene &scene = scenes.latest(); // the game state itself may be changing on the simulation thread meanwhile
         SDL_RenderClear(renderer); // SDL_RenderClear() clears the entire renderer
 
         // SDL_RenderCopy() is a function used to copy a texture onto the rendering target (usually a window or screen) during the rendering process. Allows to display an SDL_Texture on the screen at a specific position, with optional scaling and rotation.
         SDL_RenderCopy(renderer, backgroundTexture, NULL, NULL);
 
-        SDL_RenderCopy(renderer, lPaddle.texture, NULL, &lPaddle.rect); // rendering left paddle on screen
-        SDL_RenderCopy(renderer, rPaddle.texture, NULL, &rPaddle.rect); // rendering right paddle on screen
+        // paddles and ball are drawn between their last two tick positions, so they move smoothly at any frame rate
+        SDL_Rect lPaddleRect = scene.lPaddle, rPaddleRect = scene.rPaddle, ballRect = scene.ball;
+        lPaddleRect.y = interpolate(scene.prevLPaddleY, scene.lPaddle.y);
+        rPaddleRect.y = interpolate(scene.prevRPaddleY, scene.rPaddle.y);
+        ballRect.x = interpolate(scene.prevBall.x, scene.ball.x);
+        ballRect.y = interpolate(scene.prevBall.y, scene.ball.y);
 
-        SDL_RenderCopy(renderer, ballTexture, NULL, &ball); // rendering ball on screen
+        sprites.draw(paddleSprite, lPaddleRect); // rendering left paddle on screen
+        sprites.draw(paddleSprite, rPaddleRect); // rendering right paddle on screen
 
-        SDL_QueryTexture(lScoreTexture, NULL, NULL, &lScoreRect.w, &lScoreRect.h); // SDL_QueryTexture() is used to retrieve important information about a texture.
-        lScoreRect.x = (Width / 2) - SCORE_X_OFFSET - lScoreRect.w;                // setting position of left player's score
-        lScoreRect.y = SCORE_Y_OFFSET;
-        SDL_RenderCopy(renderer, lScoreTexture, NULL, &lScoreRect); // rendering left player's score on screen
+        sprites.draw(ballSprite, ballRect); // rendering ball on screen
+        sprites.flush();                    // before the scores, which are drawn as text
 
-        SDL_QueryTexture(rScoreTexture, NULL, NULL, &rScoreRect.w, &rScoreRect.h);
-        rScoreRect.x = (Width / 2) + SCORE_X_OFFSET; // setting position of right player's score
-        rScoreRect.y = SCORE_Y_OFFSET;
-        SDL_RenderCopy(renderer, rScoreTexture, NULL, &rScoreRect); // rendering right player's score on screen
+        renderScores(scene.lScore, scene.rScore);
 
         int partitionX = (Width / 2) - 5;                     // variable setting the x component for partition line
         SDL_SetRenderDrawColor(renderer, 235, 242, 240, 255); // setting the color of the partition line
@@ -385,38 +363,17 @@ private:
         {
             SDL_RenderDrawLine(renderer, partitionX, i, partitionX, i + 10); // creats a 10px line segment
         }
-        if (!running)
-        { // this block implements if the game is not running
-            msgfont = TTF_OpenFont("Oswald-Bold.ttf", 35);
-            SDL_Surface *gameOverSurface = TTF_RenderText_Solid(msgfont, "GAME OVER", textColor); // creating a surface containing rendered game over text
-            SDL_Surface *winnerSurface = TTF_RenderText_Solid(msgfont, (lScore >= 10 ? std::string("LEFT PLAYER WINS!") : std::string("RIGHT PLAYER WINS!")).c_str(), textColor);
-            // creating a surface containing rendered winner text
-
-            SDL_Texture *gameOverTexture = SDL_CreateTextureFromSurface(renderer, gameOverSurface);
-            SDL_Texture *winnerTexture = SDL_CreateTextureFromSurface(renderer, winnerSurface);
-            // creating texture from surface to render text
-
-            SDL_Rect gameOverRect;
-            gameOverRect.x = Width / 2 - gameOverSurface->w / 2;
-            gameOverRect.y = Height / 2 - gameOverSurface->h;
-            gameOverRect.w = gameOverSurface->w;
-            gameOverRect.h = gameOverSurface->h;
-
-            SDL_Rect winnerRect;
-            winnerRect.x = Width / 2 - winnerSurface->w / 2;
-            winnerRect.y = Height / 2;
-            winnerRect.w = winnerSurface->w;
-            winnerRect.h = winnerSurface->h;
-            // defining the rectangles that represent the positions and dimensions of the rendered text on the screen.
-
-            SDL_RenderCopy(renderer, gameOverTexture, NULL, &gameOverRect); // render the game over text on the screen.
-            SDL_RenderCopy(renderer, winnerTexture, NULL, &winnerRect);     // render the winner text on the screen.
-
-            SDL_FreeSurface(gameOverSurface);
-            SDL_FreeSurface(winnerSurface);
-            SDL_DestroyTexture(gameOverTexture);
-            SDL_DestroyTexture(winnerTexture);
+        if (scene.over)
+        { // this block implements if the match is over
+            string winnerText = scene.lScore >= maxScore ? "LEFT PLAYER WINS!" : "RIGHT PLAYER WINS!";
+            int gameOverW, gameOverH, winnerW;
+            textRenderer.measure(msgfont, "GAME OVER", &gameOverW, &gameOverH);
+            textRenderer.measure(msgfont, winnerText, &winnerW, NULL);
+            // measuring the texts so they can be centered on the screen
+
+            textRenderer.draw(msgfont, "GAME OVER", Width / 2 - gameOverW / 2, Height / 2 - gameOverH, textColor); // render the game over text on the screen.
+            textRenderer.draw(msgfont, winnerText, Width / 2 - winnerW / 2, Height / 2, textColor);                 // render the winner text on the screen.
         }
-        SDL_RenderPresent(renderer); // presents the rendered frame on the screen, making it visible to the user.
+        // the frame is presented by runLoop(), which also paces it
     }
 };
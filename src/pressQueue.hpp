@@ -0,0 +1,70 @@
+#ifndef PRESS_QUEUE_H
+#define PRESS_QUEUE_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_atomic.h>
+#include <vector>
+using namespace std;
+
+// PressQueue carries presses, keys going down that must each be acted on once, from the thread that polls the
+// devices to the simulation, inside the controls a SnapshotBuffer hands over. A SnapshotBuffer skips the values
+// a slower reader had no time for, which is fine for held keys but would lose presses, so the poller keeps every
+// press until the simulation reports it read it, and puts all of those into every snapshot it publishes.
+// The simulation takes the presses it has not seen yet, in order, and each one only once.
+//
+//   polling thread:     queue.push(press); queue.publishTo(input.draft().presses); input.publish(now);
+//   simulation thread:  input.acquire(); queue.take(input.latest().presses, presses);
+template <typename T>
+class PressQueue
+{
+public:
+    struct Entry
+    {
+        Uint32 sequence; // counts up from 1 in the order of the presses
+        T press;
+    };
+    typedef vector<Entry> List;
+
+    PressQueue() : pushed(0), taken(0)
+    {
+        SDL_AtomicSet(&read, 0);
+    }
+
+    // poller: a new press, after every earlier one
+    void push(const T &press)
+    {
+        Entry entry = {++pushed, press};
+        pending.push_back(entry);
+    }
+
+    // poller: drops the presses the simulation has read and copies the others into a snapshot
+    void publishTo(List &out)
+    {
+        Uint32 done = Uint32(SDL_AtomicGet(&read));
+        size_t first = 0;
+        while (first < pending.size() && pending[first].sequence <= done)
+            first++;
+        pending.erase(pending.begin(), pending.begin() + first);
+        out = pending; // the snapshot slot keeps its memory, this only allocates while presses pile up
+    }
+
+    // simulation: appends the presses of a snapshot it has not taken before, and tells the poller it has them
+    void take(const List &list, vector<T> &out)
+    {
+        for (size_t i = 0; i < list.size(); i++)
+            if (list[i].sequence > taken)
+            {
+                out.push_back(list[i].press);
+                taken = list[i].sequence;
+            }
+        SDL_AtomicSet(&read, int(taken));
+    }
+
+private:
+    List pending;      // the poller's, oldest first
+    Uint32 pushed;     // the poller's, sequence of the newest press
+    Uint32 taken;      // the simulation's, sequence of the newest press it took
+    SDL_atomic_t read; // taken, published for the poller
+};
+
+#endif // PRESS_QUEUE_H
@@ -4,9 +4,10 @@
 #include <SDL2/SDL_mixer.h>
 #include <iostream>
 #include <algorithm>
-#include <random>
 #include <string>
 #include "abstract.hpp"
+#include "pressQueue.hpp"
+#include "snapshotBuffer.hpp"
 using namespace std;
 
 const int IMAGE_WIDTH = 500;                    // setting the image width
@@ -24,21 +25,41 @@ private:
     SDL_Color textColor, msgColor;
     int grid[GRID_SIZE][GRID_SIZE]; // setting a 2D array, which will be used as puzzle grid
     SDL_Rect pieces[NUM_PIECES];
-    random_device rd;  //it is a random number generator (RNG) provided by the C++ standard library
-    mt19937 rng;  //mt19937 is a pseudo-random number generator (PRNG) from the C++ standard library's <random> header
     bool running, puzzleSolved;
     Uint32 startTime, endTime, currentTime;
     SDL_Event e;
 
+    // what the player asks for, read from the devices by pollInput() and acted on by handleEvents()
+    struct Controls
+    {
+        PressQueue<SDL_Keycode>::List presses; // every arrow key press moves a piece, none may be lost
+        bool leave = false;                    // Escape or the window was closed, stays set
+    };
+
+    // everything render() draws, copied from the game state after every tick
+    struct Scene
+    {
+        int grid[GRID_SIZE][GRID_SIZE];
+        Uint32 remainingTime = 0;
+    };
+
+    Controls controls;                // owned by the main thread
+    PressQueue<SDL_Keycode> presses;  // the key presses in controls, until the simulation took them
+    vector<SDL_Keycode> pressed;      // the simulation's, the presses of the current tick
+    SnapshotBuffer<Controls> input;   // main thread to simulation
+    SnapshotBuffer<Scene> scenes;     // simulation to main thread
+
     bool initialize()
     {
         SDL_RenderClear(renderer);
         // Load the background image
-        SDL_Surface *backgroundSurface = IMG_Load("images/bg.png");
+        SDL_Surface *backgroundSurface = loadSurface("images/bg.png");
         backgroundTexture = SDL_CreateTextureFromSurface(renderer, backgroundSurface);
         SDL_FreeSurface(backgroundSurface);
 
-        texture = IMG_LoadTexture(renderer, "images/grid.PNG");
+        SDL_Surface *gridSurface = loadSurface("images/grid.PNG");
+        texture = SDL_CreateTextureFromSurface(renderer, gridSurface);
+        SDL_FreeSurface(gridSurface);
         int pieceIndex = 0;
         for (int i = 0; i < GRID_SIZE; i++)
         {
@@ -54,16 +75,16 @@ private:
         }
 
         // Shuffle the positions of the pieces randomly
-        rng = mt19937(rd());
+        seedRng(); // Arcade's Rng, the same seed gives the same puzzle
         shuffle(&grid[0][0], &grid[GRID_SIZE - 1][GRID_SIZE - 1] + 1, rng);
         // Variables for timer
-        startTime = SDL_GetTicks();
+        startTime = gameTime(); // simulated time, so the countdown follows the game speed
         endTime = startTime + (GAME_DURATION * 1000); // Convert to milliseconds
-        font = TTF_OpenFont("Oswald-Bold.ttf", 40);
+        font = fonts().get("Oswald-Bold.ttf", 40);
         textColor = {0, 0, 0, 255};
-        msgfont = TTF_OpenFont("Oswald-Bold.ttf", 100);
-        msgColor = {0, 0, 0};
-        backgroundMusic = Mix_LoadMUS("sound/puzzle.mp3");
+        msgfont = fonts().get("Oswald-Bold.ttf", 100);
+        msgColor = {0, 0, 0, 255};
+        backgroundMusic = loadMusic("sound/puzzle.mp3");
         if (backgroundTexture == nullptr || backgroundMusic == nullptr || font == nullptr || msgfont == nullptr)
         {
             cout << "Failed to initialize" << endl;
@@ -79,105 +100,129 @@ private:
         SDL_DestroyTexture(backgroundTexture);
     }
 
-    void handleEvents()
+    void pollInput()
     {
+        // on the main thread, the simulation may run on another one and only sees the controls
         while (SDL_PollEvent(&e))
         {
             if (e.type == SDL_QUIT)
-                running = false;
-
-            if (e.type == SDL_KEYDOWN)
             {
-                int emptyPieceX = 0;
-                int emptyPieceY = 0;
-                bool foundEmptyPiece = false;
+                requestQuit(); // closing the window closes the arcade, not just this game
+                controls.leave = true;
+            }
+            else if (e.type == SDL_KEYDOWN)
+            {
+                if (e.key.keysym.sym == SDLK_ESCAPE)
+                    controls.leave = true;
+                else
+                    presses.push(e.key.keysym.sym);
+            }
+        }
+        presses.publishTo(controls.presses);
+        input.draft() = controls;
+        input.publish(FrameProfiler::now());
+    }
 
-                // Find empty piece
-                for (int i = 0; i < GRID_SIZE; i++)
-                {
-                    for (int j = 0; j < GRID_SIZE; j++)
-                    {
-                        if (grid[i][j] == NUM_PIECES - 1)
-                        {
-                            emptyPieceX = j;
-                            emptyPieceY = i;
-                            foundEmptyPiece = true;
-                            break;
-                        }
-                    }
-                    if (foundEmptyPiece)
-                        break;
-                }
+    void handleEvents()
+    {
+        // the presses of the newest pollInput() that were not acted on yet, in the order they came
+        input.acquire();
+        if (input.latest().leave)
+            running = false;
+        pressed.clear();
+        presses.take(input.latest().presses, pressed);
+        for (size_t i = 0; i < pressed.size(); i++)
+            press(pressed[i]);
+    }
 
-                int clickedPieceX = emptyPieceX;
-                int clickedPieceY = emptyPieceY;
+    void press(SDL_Keycode key)
+    {
+        // moves the piece next to the empty one that the arrow points away from
+        int emptyPieceX = 0;
+        int emptyPieceY = 0;
+        bool foundEmptyPiece = false;
 
-                switch (e.key.keysym.sym)
+        // Find empty piece
+        for (int i = 0; i < GRID_SIZE; i++)
+        {
+            for (int j = 0; j < GRID_SIZE; j++)
+            {
+                if (grid[i][j] == NUM_PIECES - 1)
                 {
-                case SDLK_ESCAPE:
-                    running = false;
-                    break;
-                case SDLK_UP:
-                    clickedPieceY++;
-                    break;
-                case SDLK_DOWN:
-                    clickedPieceY--;
-                    break;
-                case SDLK_LEFT:
-                    if (emptyPieceX == GRID_SIZE - 1)
-                    {
-                        if (emptyPieceY == 0)
-                        {
-                            swap(grid[1][0], grid[emptyPieceY][emptyPieceX]);
-                        }
-                        else if (emptyPieceY == 1)
-                        {
-                            swap(grid[2][0], grid[emptyPieceY][emptyPieceX]);
-                        }
-                        else if (emptyPieceY == 2)
-                        {
-                            swap(grid[3][0], grid[emptyPieceY][emptyPieceX]);
-                        }
-                    }
-                    else
-                    {
-                        clickedPieceX++;
-                    }
-                    break;
-                case SDLK_RIGHT:
-                    if (emptyPieceX == 0)
-                    {
-                        if (emptyPieceY == 1)
-                        {
-                            swap(grid[0][3], grid[emptyPieceY][emptyPieceX]);
-                        }
-                        else if (emptyPieceY == 2)
-                        {
-                            swap(grid[1][3], grid[emptyPieceY][emptyPieceX]);
-                        }
-                        else if (emptyPieceY == 3)
-                        {
-                            swap(grid[2][3], grid[emptyPieceY][emptyPieceX]);
-                        }
-                    }
-                    else
-                    {
-                        clickedPieceX--;
-                    }
-                    break;
-                default:
+                    emptyPieceX = j;
+                    emptyPieceY = i;
+                    foundEmptyPiece = true;
                     break;
                 }
+            }
+            if (foundEmptyPiece)
+                break;
+        }
 
-                // Check if the clicked piece is adjacent to the empty piece
-                if (((clickedPieceX == emptyPieceX && abs(clickedPieceY - emptyPieceY) == 1) ||
-                     (clickedPieceY == emptyPieceY && abs(clickedPieceX - emptyPieceX) == 1)) &&
-                    clickedPieceX >= 0 && clickedPieceX < GRID_SIZE && clickedPieceY >= 0 && clickedPieceY < GRID_SIZE)
+        int clickedPieceX = emptyPieceX;
+        int clickedPieceY = emptyPieceY;
+
+        switch (key)
+        {
+        case SDLK_UP:
+            clickedPieceY++;
+            break;
+        case SDLK_DOWN:
+            clickedPieceY--;
+            break;
+        case SDLK_LEFT:
+            if (emptyPieceX == GRID_SIZE - 1)
+            {
+                if (emptyPieceY == 0)
+                {
+                    swap(grid[1][0], grid[emptyPieceY][emptyPieceX]);
+                }
+                else if (emptyPieceY == 1)
+                {
+                    swap(grid[2][0], grid[emptyPieceY][emptyPieceX]);
+                }
+                else if (emptyPieceY == 2)
+                {
+                    swap(grid[3][0], grid[emptyPieceY][emptyPieceX]);
+                }
+            }
+            else
+            {
+                clickedPieceX++;
+            }
+            break;
+        case SDLK_RIGHT:
+            if (emptyPieceX == 0)
+            {
+                if (emptyPieceY == 1)
+                {
+                    swap(grid[0][3], grid[emptyPieceY][emptyPieceX]);
+                }
+                else if (emptyPieceY == 2)
+                {
+                    swap(grid[1][3], grid[emptyPieceY][emptyPieceX]);
+                }
+                else if (emptyPieceY == 3)
                 {
-                    // Swap positions in the grid
-                    swap(grid[clickedPieceY][clickedPieceX], grid[emptyPieceY][emptyPieceX]);
+                    swap(grid[2][3], grid[emptyPieceY][emptyPieceX]);
                 }
             }
+            else
+            {
+                clickedPieceX--;
+            }
+            break;
+        default:
+            break;
+        }
+
+        // Check if the clicked piece is adjacent to the empty piece
+        if (((clickedPieceX == emptyPieceX && abs(clickedPieceY - emptyPieceY) == 1) ||
+             (clickedPieceY == emptyPieceY && abs(clickedPieceX - emptyPieceX) == 1)) &&
+            clickedPieceX >= 0 && clickedPieceX < GRID_SIZE && clickedPieceY >= 0 && clickedPieceY < GRID_SIZE)
+        {
+            // Swap positions in the grid
+            swap(grid[clickedPieceY][clickedPieceX], grid[emptyPieceY][emptyPieceX]);
         }
     }
 
@@ -217,6 +262,8 @@ private:
 
     void render()
     {
+        // only the newest scene, the grid itself may be changing on the simulation thread meanwhile
+        const Scene &scene = scenes.latest();
         SDL_RenderClear(renderer);
 
         SDL_RenderCopy(renderer, backgroundTexture, nullptr, nullptr);
@@ -233,40 +280,22 @@ private:
             destRect.w = PIECE_SIZE;
             destRect.h = PIECE_SIZE;
 
-            SDL_RenderCopy(renderer, texture, &pieces[grid[pieceY][pieceX]], &destRect);
+            sprites.draw(texture, &pieces[scene.grid[pieceY][pieceX]], destRect); // every piece cut from one texture, one draw call
         }
+        sprites.flush();
         // Render the timer
-        currentTime = SDL_GetTicks();
-        Uint32 remainingTime = endTime > currentTime ? endTime - currentTime : 0;
-        string timeStr = formatTime(remainingTime);
-        SDL_Surface *timeSurface = TTF_RenderText_Solid(font, timeStr.c_str(), textColor);
-        SDL_Texture *timeTexture = SDL_CreateTextureFromSurface(renderer, timeSurface);
-        SDL_Rect timeRect;
-        timeRect.x = Width - timeSurface->w - 110; // Adjust the position as needed
-        timeRect.y = 10;                           // Adjust the position as needed
-        timeRect.w = timeSurface->w;
-        timeRect.h = timeSurface->h;
-        SDL_RenderCopy(renderer, timeTexture, nullptr, &timeRect);
-        SDL_FreeSurface(timeSurface);
-        SDL_DestroyTexture(timeTexture);
-
-        SDL_RenderPresent(renderer);
+        string timeStr = formatTime(scene.remainingTime);
+        int timeW;
+        textRenderer.measure(font, timeStr, &timeW, nullptr);
+        textRenderer.draw(font, timeStr, Width - timeW - 110, 10, textColor); // Adjust the position as needed
     }
 
     void displayWonMessage()
     {  //displaying won message on screen
 
-        SDL_Surface *surface = TTF_RenderText_Solid(msgfont, "You won!", msgColor);
-        SDL_Texture *textTexture = SDL_CreateTextureFromSurface(renderer, surface);
-        SDL_Rect textRect;
-        textRect.x = (Width - surface->w) / 2;
-        textRect.y = (Height - surface->h) / 2;
-        textRect.w = surface->w;
-        textRect.h = surface->h;
-        SDL_RenderCopy(renderer, textTexture, nullptr, &textRect);
-
-        SDL_FreeSurface(surface);
-        SDL_DestroyTexture(textTexture);
+        int w, h;
+        textRenderer.measure(msgfont, "You won!", &w, &h);
+        textRenderer.draw(msgfont, "You won!", (Width - w) / 2, (Height - h) / 2, msgColor);
 
         // Update the renderer
         SDL_RenderPresent(renderer);
@@ -280,41 +309,57 @@ private:
             while (SDL_PollEvent(&e))
             {
                 if (e.type == SDL_QUIT)
-                    running = false;
+                    requestQuit();
             }
+            SDL_Delay(10); // waiting without keeping a core busy
         }
         running = false; // Stop the game
     }
     void displayGameOverMessage()
     {
-        SDL_Surface *surface = TTF_RenderText_Solid(msgfont, "Game Over", msgColor);
-        SDL_Texture *textTexture = SDL_CreateTextureFromSurface(renderer, surface);
-        SDL_Rect textRect;
-        textRect.x = (Width - surface->w) / 2;
-        textRect.y = (Height - surface->h) / 2;
-        textRect.w = surface->w;
-        textRect.h = surface->h;
-        SDL_RenderCopy(renderer, textTexture, nullptr, &textRect);
-
-        SDL_FreeSurface(surface);
-        SDL_DestroyTexture(textTexture);
+        int w, h;
+        textRenderer.measure(msgfont, "Game Over", &w, &h);
+        textRenderer.draw(msgfont, "Game Over", (Width - w) / 2, (Height - h) / 2, msgColor);
 
         // Update the renderer
         SDL_RenderPresent(renderer);
     }
     void update()
     {
+        // the game ends when the puzzle is solved or the time is up, run() shows which
+        currentTime = gameTime();
         puzzleSolved = isPuzzleSolved();
-        if (puzzleSolved)
-        {
-            displayWonMessage();
-            delay();
-        }
-        else if (currentTime >= endTime)
-        {
-            displayGameOverMessage();
-            delay();
-        }
+        if (puzzleSolved || currentTime >= endTime)
+            running = false;
+    }
+    bool isRunning()
+    {
+        return running;
+    }
+
+    bool publishesSnapshots()
+    {
+        return true;
+    }
+
+    void publishSnapshot(Uint64 tickTime)
+    {
+        Scene &scene = scenes.draft();
+        copy(&grid[0][0], &grid[0][0] + NUM_PIECES, &scene.grid[0][0]);
+        scene.remainingTime = endTime > currentTime ? endTime - currentTime : 0;
+        scenes.publish(tickTime);
+    }
+
+    Uint64 acquireSnapshot()
+    {
+        scenes.acquire();
+        return scenes.latestStamp();
+    }
+
+    Uint32 stateChecksum()
+    {
+        // the pieces are the whole state of the puzzle
+        return StateHash().add(grid).add(puzzleSolved).result();
     }
 
 public:
@@ -322,12 +367,22 @@ public:
     void run()
     {  //method controlling the whole game
         initialize();
-        while (running)
+        currentTime = startTime;
+        runLoop(); // input, update and render at a fixed tick rate until the puzzle is solved or the time is up
+        if (!isHeadless() && (puzzleSolved || currentTime >= endTime))
         {
-            handleEvents();
-            update();
+            // the simulation has stopped, the message goes on top of its last scene
+            acquireSnapshot();
             render();
+            sprites.flush();
+            if (puzzleSolved)
+                displayWonMessage();
+            else
+                displayGameOverMessage();
+            delay();
         }
+        if (puzzleSolved && currentTime < endTime)
+            submitScore((endTime - currentTime) / 1000); // seconds left on the clock
         cleanup();
     }
 };
\ No newline at end of file
@@ -0,0 +1,85 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <SDL2/SDL.h>
+
+// Rng is a xoshiro256** pseudo-random generator, small and fast, with no global state.
+// Every game owns one, so a run is reproducible from its seed and games never disturb each other's sequence.
+// It satisfies UniformRandomBitGenerator, so it also works with std::shuffle and the <random> distributions.
+class Rng
+{
+public:
+    typedef Uint64 result_type;
+
+    explicit Rng(Uint64 seed = 1)
+    {
+        this->seed(seed);
+    }
+
+    void seed(Uint64 value)
+    {
+        // splitmix64 spreads the seed over the whole state, so small seeds like 1, 2, 3 give unrelated sequences
+        for (int i = 0; i < 4; i++)
+        {
+            value += 0x9E3779B97F4A7C15ULL;
+            Uint64 z = value;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            state[i] = z ^ (z >> 31);
+        }
+    }
+
+    Uint64 next()
+    {
+        Uint64 result = rotl(state[1] * 5, 7) * 9;
+        Uint64 t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+
+    // the whole state, for checksums of a run: generators with equal states give equal sequences
+    const Uint64 *stateWords() const
+    {
+        return state;
+    }
+
+    int below(int n)
+    {
+        // uniform in [0, n) without the modulo bias of rand() % n, n must be positive
+        return int(((next() >> 32) * Uint64(Uint32(n))) >> 32);
+    }
+
+    int range(int low, int high)
+    {
+        // uniform in [low, high], both ends included
+        return low + below(high - low + 1);
+    }
+
+    static constexpr result_type min()
+    {
+        return 0;
+    }
+    static constexpr result_type max()
+    {
+        return ~Uint64(0);
+    }
+    result_type operator()()
+    {
+        return next();
+    }
+
+private:
+    Uint64 state[4];
+
+    static Uint64 rotl(Uint64 x, int k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+};
+
+#endif // RNG_H
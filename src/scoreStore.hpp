@@ -0,0 +1,211 @@
+#ifndef SCORE_STORE_H
+#define SCORE_STORE_H
+
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX // windows.h would otherwise turn min and max into macros
+#endif
+#include <windows.h> // MoveFileExA, rename() on Windows refuses to replace an existing file
+#endif
+using namespace std;
+
+// ScoreStore keeps the leaderboard of every game in memory.
+// The file is read once when the store is created; reads never touch it again, and submitted scores are
+// written behind by a background thread to a temporary file that is then renamed over the old one,
+// so a crash mid-write never leaves a half-written score file.
+class ScoreStore
+{
+public:
+    enum
+    {
+        BoardSize = 10 // scores kept per game
+    };
+
+    ScoreStore(const string &path = "Scores.txt", const string &legacyPath = "Score.txt")
+        : path(path), lock(SDL_CreateMutex()), changed(SDL_CreateCond()), writer(nullptr), dirty(false), stopping(false), writes(0)
+    {
+        load(legacyPath);
+    }
+
+    ~ScoreStore()
+    {
+        close();
+        SDL_DestroyCond(changed);
+        SDL_DestroyMutex(lock);
+    }
+
+    int best(const string &game)
+    {
+        SDL_LockMutex(lock);
+        map<string, vector<int>>::const_iterator it = boards.find(game);
+        int score = it != boards.end() && !it->second.empty() ? it->second[0] : 0;
+        SDL_UnlockMutex(lock);
+        return score;
+    }
+
+    vector<int> leaderboard(const string &game)
+    {
+        // highest first, at most BoardSize scores
+        SDL_LockMutex(lock);
+        vector<int> board = boards[game];
+        SDL_UnlockMutex(lock);
+        return board;
+    }
+
+    // records a score and returns true if it made the leaderboard; the file is written later by the writer thread
+    bool submit(const string &game, int score)
+    {
+        SDL_LockMutex(lock);
+        bool ranked = insert(game, score);
+        if (ranked)
+        {
+            dirty = true;
+            if (!writer)
+                writer = SDL_CreateThread(writeBehind, "scores", this);
+            SDL_CondSignal(changed);
+        }
+        SDL_UnlockMutex(lock);
+        return ranked;
+    }
+
+    void close()
+    {
+        // waits until pending scores are on disk and stops the writer; a later submit starts it again
+        SDL_LockMutex(lock);
+        SDL_Thread *thread = writer;
+        stopping = true;
+        SDL_CondSignal(changed);
+        SDL_UnlockMutex(lock);
+        if (thread)
+            SDL_WaitThread(thread, nullptr);
+
+        SDL_LockMutex(lock);
+        writer = nullptr;
+        stopping = false;
+        SDL_UnlockMutex(lock);
+    }
+
+    int writeCount()
+    {
+        // times the file was rewritten, several quick submits are coalesced into one write
+        SDL_LockMutex(lock);
+        int count = writes;
+        SDL_UnlockMutex(lock);
+        return count;
+    }
+
+private:
+    string path;
+    map<string, vector<int>> boards; // game name -> scores, highest first
+    SDL_mutex *lock;
+    SDL_cond *changed; // signalled when there is something to write or the writer should stop
+    SDL_Thread *writer;
+    bool dirty, stopping;
+    int writes;
+
+    void load(const string &legacyPath)
+    {
+        // one line per game: "<game> <score> <score> ..."
+        ifstream file(path);
+        string line;
+        while (getline(file, line))
+        {
+            istringstream fields(line);
+            string game;
+            int score;
+            if (!(fields >> game))
+                continue;
+            while (fields >> score)
+                insert(game, score);
+        }
+        if (file.is_open())
+            return;
+
+        // before the store, AstroStrike kept its single high score in its own file
+        ifstream legacy(legacyPath);
+        int score;
+        if (legacy >> score)
+            insert("Astrostrike", score); // moves into the new file with the next write
+    }
+
+    bool insert(const string &game, int score)
+    {
+        vector<int> &board = boards[game];
+        vector<int>::iterator at = upper_bound(board.begin(), board.end(), score, greater<int>());
+        if (at - board.begin() >= BoardSize)
+            return false;
+        board.insert(at, score);
+        if (board.size() > BoardSize)
+            board.pop_back();
+        return true;
+    }
+
+    static int writeBehind(void *data)
+    {
+        ScoreStore *store = static_cast<ScoreStore *>(data);
+        SDL_LockMutex(store->lock);
+        for (;;)
+        {
+            while (!store->dirty && !store->stopping)
+                SDL_CondWait(store->changed, store->lock);
+            if (!store->dirty)
+                break; // stopping with nothing left to write
+
+            map<string, vector<int>> snapshot = store->boards;
+            store->dirty = false;
+            SDL_UnlockMutex(store->lock); // the game keeps submitting and reading while the file is written
+            bool written = store->save(snapshot);
+            SDL_LockMutex(store->lock);
+            if (written)
+                store->writes++;
+            if (store->stopping && !store->dirty)
+                break;
+        }
+        SDL_UnlockMutex(store->lock);
+        return 0;
+    }
+
+    bool save(const map<string, vector<int>> &snapshot) const
+    {
+        string temporary = path + ".tmp";
+        {
+            ofstream file(temporary, ios::trunc);
+            for (map<string, vector<int>>::const_iterator it = snapshot.begin(); it != snapshot.end(); ++it)
+            {
+                file << it->first;
+                for (size_t i = 0; i < it->second.size(); i++)
+                    file << ' ' << it->second[i];
+                file << '\n';
+            }
+            file.flush();
+            if (!file)
+            {
+                cout << "Failed to write scores to " << temporary << endl;
+                return false;
+            }
+        }
+#ifdef _WIN32
+        bool renamed = MoveFileExA(temporary.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+        bool renamed = rename(temporary.c_str(), path.c_str()) == 0;
+#endif
+        if (!renamed)
+            cout << "Failed to replace " << path << endl;
+        return renamed;
+    }
+};
+
+#endif // SCORE_STORE_H
@@ -0,0 +1,152 @@
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <SDL2/SDL_mixer.h>
+#include <SDL2/SDL_ttf.h>
+#include <iostream>
+#include "assetCache.hpp"
+#include "soundEffects.hpp"
+#include "spriteBatch.hpp"
+#include "textRenderer.hpp"
+using namespace std;
+
+// Session owns everything that should exist once per process: the SDL subsystems, the window, the renderer,
+// the audio device and the caches built on top of the renderer. Games are scenes inside it; entering one
+// only retitles and resizes the window, so switching between the menu and a game costs no re-initialization.
+class Session
+{
+public:
+    enum
+    {
+        OffscreenWidth = 1024, // the offscreen surface of a rendering headless run is large enough for every game
+        OffscreenHeight = 768
+    };
+
+    Session() : window(nullptr), renderer(nullptr), offscreen(nullptr), opened(false), audio(false), quit(false) {}
+
+    // brings SDL up; later calls while the session is open do nothing
+    bool open(const char *title, int width, int height, bool headless, bool headlessRender, bool vsync)
+    {
+        if (opened)
+            return true;
+        opened = true;
+        quit = false;
+
+        if (headless)
+        {
+            // only the event queue is needed, the scripted input is delivered through it
+            SDL_Init(SDL_INIT_EVENTS | SDL_INIT_TIMER);
+            IMG_Init(IMG_INIT_PNG | IMG_INIT_JPG);
+            TTF_Init();
+            if (headlessRender)
+            {
+                // the software renderer draws into plain memory, so it works without a display or GPU
+                offscreen = SDL_CreateRGBSurfaceWithFormat(0, OffscreenWidth, OffscreenHeight, 32, SDL_PIXELFORMAT_ARGB8888);
+                renderer = offscreen ? SDL_CreateSoftwareRenderer(offscreen) : nullptr;
+                if (!renderer)
+                    cout << "Failed to create offscreen renderer: " << SDL_GetError() << endl;
+            }
+        }
+        else
+        {
+            SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO); // SDL_Init initializes the SDL. The parameter specifies what part(s)/subsystems of SDL to initialize.
+
+            window = SDL_CreateWindow(title, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, width, height, SDL_WINDOW_SHOWN);
+            // SDL_CreateWindow creates the one window of the arcade, every game is shown in it.
+
+            renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | (vsync ? SDL_RENDERER_PRESENTVSYNC : 0));
+            // SDL_CreateRenderer creates a hardware-accelerated renderer associated with the window, synced to the display if vsync is on.
+            IMG_Init(IMG_INIT_PNG | IMG_INIT_JPG);                     // This initializes the SDL_image extension with support for PNG and JPG image loading.
+            TTF_Init();                                                // TTF_Init() initializes SDL_ttf which allows to load and render TrueType fonts in SDL applications.
+            Mix_Init(MIX_INIT_MP3);                                    // This line initializes specific components of the SDL_mixer library for handling MP3 audio format.
+            audio = Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) == 0; // the audio device stays open for the whole session
+        }
+        assets.setRenderer(renderer); // every image is decoded once through this cache, for every game
+        sounds.setAudio(audio);       // and every sound effect through this one
+        text.setRenderer(renderer);
+        sprites.setRenderer(renderer);
+        return renderer != nullptr || headless;
+    }
+
+    void close()
+    {
+        if (!opened)
+            return;
+        text.clear(); // glyph atlases are textures of the renderer
+        fonts.closeAll(); // fonts must be closed before TTF_Quit
+        sounds.clear(); // the chunks go before the audio device does
+        sounds.setAudio(false);
+        if (audio)
+        {
+            Mix_HaltMusic();
+            Mix_CloseAudio();
+        }
+        SDL_DestroyRenderer(renderer);
+        SDL_DestroyWindow(window);
+        SDL_FreeSurface(offscreen);
+        renderer = nullptr;
+        window = nullptr;
+        offscreen = nullptr;
+        assets.setRenderer(nullptr);
+        text.setRenderer(nullptr);
+        sprites.setRenderer(nullptr);
+        audio = false;
+        opened = false;
+        TTF_Quit();
+        Mix_Quit();
+        IMG_Quit();
+        SDL_Quit();
+    }
+
+    void enter(const char *title, int width, int height)
+    {
+        // a scene takes over the window with its own title and size
+        if (!window)
+            return;
+        SDL_SetWindowTitle(window, title);
+        int w, h;
+        SDL_GetWindowSize(window, &w, &h);
+        if (w != width || h != height)
+        {
+            SDL_SetWindowSize(window, width, height);
+            SDL_SetWindowPosition(window, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED);
+        }
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+        SDL_RenderClear(renderer);
+        sounds.stopAll(); // sound effects of the previous scene should not carry over
+    }
+
+    void requestQuit()
+    {
+        // the player closed the window: the current scene ends and so does the arcade
+        quit = true;
+    }
+
+    bool quitRequested() const
+    {
+        return quit;
+    }
+
+    bool hasAudio() const
+    {
+        return audio;
+    }
+
+    SDL_Window *window;
+    SDL_Renderer *renderer;
+    AssetCache assets;
+    TextRenderer text;
+    SpriteBatch sprites;
+    FontRegistry fonts;
+    SoundEffects sounds;
+
+private:
+    SDL_Surface *offscreen; // what the software renderer of a rendering headless run draws into
+    bool opened;
+    bool audio;
+    bool quit;
+};
+
+#endif // SESSION_H
@@ -0,0 +1,75 @@
+#ifndef SNAPSHOT_BUFFER_H
+#define SNAPSHOT_BUFFER_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_atomic.h>
+
+// SnapshotBuffer hands values from one thread to another without locks: a triple buffer.
+// The writer fills draft() and publishes it, the reader acquires the newest published value and reads latest().
+// Of the three slots one belongs to the writer, one to the reader and one is in between; publish() and acquire()
+// each swap their own slot with the one in between, so neither side ever waits for the other, and a reader
+// that is slower than the writer skips the values it had no time for.
+// The slots are reused, so a value holding vectors keeps their memory and publishing does not allocate.
+//
+//   simulation thread:  fill(scenes.draft()); scenes.publish(tickTime);
+//   render thread:      scenes.acquire(); draw(scenes.latest());
+template <typename T>
+class SnapshotBuffer
+{
+public:
+    SnapshotBuffer() : back(2), front(0)
+    {
+        stamps[0] = stamps[1] = stamps[2] = 0;
+        SDL_AtomicSet(&middle, 1); // nothing published yet
+    }
+
+    // writer: the slot to fill, it holds whatever was published in it before
+    T &draft()
+    {
+        return slots[back];
+    }
+
+    // writer: makes the draft the newest value, stamp is any number the reader wants with it (e.g. a time)
+    void publish(Uint64 stamp)
+    {
+        stamps[back] = stamp;
+        SDL_MemoryBarrierRelease(); // the draft is written before the reader can see it
+        back = SDL_AtomicSet(&middle, back | Fresh) & IndexMask;
+    }
+
+    // reader: takes the newest published value, returns false if nothing was published since the last call
+    bool acquire()
+    {
+        if (!(SDL_AtomicGet(&middle) & Fresh))
+            return false;
+        front = SDL_AtomicSet(&middle, front) & IndexMask;
+        SDL_MemoryBarrierAcquire(); // the value is read after it was written
+        return true;
+    }
+
+    // reader: the value taken by the last acquire(), a default constructed T before the first one
+    const T &latest() const
+    {
+        return slots[front];
+    }
+
+    Uint64 latestStamp() const
+    {
+        return stamps[front];
+    }
+
+private:
+    enum
+    {
+        IndexMask = 3,
+        Fresh = 4 // set in middle while its slot has not been acquired
+    };
+
+    T slots[3];
+    Uint64 stamps[3];
+    int back;            // the writer's slot
+    int front;           // the reader's slot
+    SDL_atomic_t middle; // the slot in between, with the Fresh bit
+};
+
+#endif // SNAPSHOT_BUFFER_H
@@ -0,0 +1,219 @@
+#ifndef SOUND_EFFECTS_H
+#define SOUND_EFFECTS_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_atomic.h>
+#include <SDL2/SDL_mixer.h>
+#include <string>
+#include <vector>
+#include "assetArchive.hpp"
+using namespace std;
+
+// SoundEffects decides which sound effects get one of the mixer's voices (channels).
+// Games ask for a sound with play() as often as they like; the requests are only counted, and once per frame
+// flush() starts at most one voice per sound, however many times it was asked for (the rest are merged).
+// A sound never has more than its maxVoices playing at once; when every voice is busy, a sound may take over
+// the oldest voice of a sound with a lower priority, otherwise the request is dropped.
+// Sounds are decoded once per session and stay in memory, a game that comes back does not load them again.
+// play() may be called from the simulation thread, everything else belongs to the main thread.
+class SoundEffects
+{
+public:
+    enum Priority
+    {
+        Low,
+        Normal,
+        High
+    };
+
+    enum
+    {
+        Voices = 16 // mixer channels for sound effects, the music has a channel of its own
+    };
+
+    struct Stats
+    {
+        Uint64 requested; // play() calls
+        Uint64 played;    // voices started
+        Uint64 merged;    // requests folded into another one of the same frame
+        Uint64 dropped;   // requests with no voice left for them
+        Uint64 stolen;    // voices cut off for a sound with a higher priority
+    };
+
+    SoundEffects() : archive(nullptr), audio(false), started(0)
+    {
+        resetStats();
+    }
+
+    void setArchive(const AssetArchive *packed)
+    {
+        archive = packed;
+    }
+
+    // the session tells whether there is an audio device; without one nothing is loaded or played
+    void setAudio(bool open)
+    {
+        audio = open;
+        voices.assign(open ? Voices : 0, Voice());
+        if (open)
+            Mix_AllocateChannels(Voices);
+    }
+
+    // returns the id play() takes, or -1 if the sound could not be loaded; loading it again only updates its limits
+    int load(const string &path, Priority priority = Normal, int maxVoices = 2)
+    {
+        for (size_t i = 0; i < sounds.size(); i++)
+            if (sounds[i].path == path)
+            {
+                sounds[i].priority = priority;
+                sounds[i].maxVoices = maxVoices > 0 ? maxVoices : 1;
+                return int(i);
+            }
+        if (!audio)
+            return -1;
+
+        // Mix_LoadWAV decodes the whole file, mp3 included, so playing it later costs no decoding
+        SDL_RWops *stream = archive ? archive->openRW(path) : nullptr;
+        Mix_Chunk *chunk = stream ? Mix_LoadWAV_RW(stream, 1) : Mix_LoadWAV(path.c_str());
+        if (!chunk)
+            return -1;
+        Sound sound;
+        sound.path = path;
+        sound.chunk = chunk;
+        sound.priority = priority;
+        sound.maxVoices = maxVoices > 0 ? maxVoices : 1;
+        SDL_AtomicSet(&sound.requests, 0);
+        sounds.push_back(sound);
+        return int(sounds.size()) - 1;
+    }
+
+    // asks for the sound to be played with the next flush(); ids of sounds that failed to load are ignored
+    void play(int id)
+    {
+        if (id >= 0 && id < int(sounds.size()))
+            SDL_AtomicAdd(&sounds[id].requests, 1);
+    }
+
+    // starts the sounds asked for since the last flush(), the ones with the highest priority first
+    void flush()
+    {
+        for (int priority = High; priority >= Low; priority--)
+            for (size_t i = 0; i < sounds.size(); i++)
+            {
+                if (sounds[i].priority != priority)
+                    continue;
+                int requests = SDL_AtomicSet(&sounds[i].requests, 0);
+                if (!requests)
+                    continue;
+                stats.requested += requests;
+                stats.merged += requests - 1;
+                start(int(i));
+            }
+    }
+
+    void stopAll()
+    {
+        // the sounds of a scene, playing or asked for, do not carry over to the next one
+        if (audio)
+            Mix_HaltChannel(-1);
+        for (size_t i = 0; i < sounds.size(); i++)
+            SDL_AtomicSet(&sounds[i].requests, 0);
+    }
+
+    void clear()
+    {
+        // the chunks must be freed before the audio device is closed
+        stopAll();
+        for (size_t i = 0; i < sounds.size(); i++)
+            Mix_FreeChunk(sounds[i].chunk);
+        sounds.clear();
+    }
+
+    const Stats &statistics() const
+    {
+        return stats;
+    }
+
+    void resetStats()
+    {
+        stats = Stats();
+    }
+
+private:
+    struct Sound
+    {
+        string path;
+        Mix_Chunk *chunk;
+        Priority priority;
+        int maxVoices;
+        SDL_atomic_t requests; // play() calls since the last flush()
+    };
+
+    struct Voice
+    {
+        int sound = -1;     // what the channel played last
+        Uint64 started = 0; // when, in voices started, to find the oldest
+    };
+
+    const AssetArchive *archive;
+    bool audio;
+    vector<Sound> sounds;
+    vector<Voice> voices; // one per channel
+    Uint64 started;
+    Stats stats;
+
+    void start(int id)
+    {
+        const Sound &sound = sounds[id];
+        int playing = 0, idle = -1, victim = -1;
+        for (int channel = 0; channel < int(voices.size()); channel++)
+        {
+            if (!Mix_Playing(channel))
+            {
+                if (idle < 0)
+                    idle = channel;
+                continue;
+            }
+            const Voice &voice = voices[channel];
+            if (voice.sound == id)
+            {
+                playing++;
+                continue;
+            }
+            // the victim is the oldest voice among those of the lowest priority below this sound's
+            Priority other = voice.sound >= 0 ? sounds[voice.sound].priority : Low;
+            if (other >= sound.priority)
+                continue;
+            if (victim < 0)
+                victim = channel;
+            else
+            {
+                Priority worst = voices[victim].sound >= 0 ? sounds[voices[victim].sound].priority : Low;
+                if (other < worst || (other == worst && voice.started < voices[victim].started))
+                    victim = channel;
+            }
+        }
+
+        int channel = idle >= 0 ? idle : victim;
+        if (playing >= sound.maxVoices || channel < 0)
+        {
+            stats.dropped++;
+            return;
+        }
+        if (idle < 0)
+        {
+            Mix_HaltChannel(channel);
+            stats.stolen++;
+        }
+        if (Mix_PlayChannel(channel, sound.chunk, 0) < 0)
+        {
+            stats.dropped++;
+            return;
+        }
+        voices[channel].sound = id;
+        voices[channel].started = ++started;
+        stats.played++;
+    }
+};
+
+#endif // SOUND_EFFECTS_H
@@ -0,0 +1,134 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include <SDL2/SDL.h>
+#include <vector>
+using namespace std;
+
+// SpatialGrid is the broad phase of a collision test: the playfield is cut into square cells, every
+// target is filed under the cells its rectangle touches, and a query only returns the targets filed
+// under the cells it touches itself. The exact rectangle test (the narrow phase) then only runs on those.
+// It is meant to be cleared and filled again every tick; the cells keep their memory between ticks.
+// Rectangles reaching past the playfield are clamped to its border cells, so nothing is ever missed.
+class SpatialGrid
+{
+public:
+    struct Counters
+    {
+        Uint64 queries;        // query() calls
+        Uint64 candidatePairs; // ids returned by query(), the pairs that reach the narrow phase
+    };
+
+    SpatialGrid(int width = 0, int height = 0, int cellSize = 1, int idCount = 0)
+    {
+        reset(width, height, cellSize, idCount);
+    }
+
+    // ids go from 0 to idCount - 1
+    void reset(int width, int height, int cellSize, int idCount)
+    {
+        this->cellSize = cellSize > 0 ? cellSize : 1;
+        columns = (width + this->cellSize - 1) / this->cellSize;
+        rows = (height + this->cellSize - 1) / this->cellSize;
+        if (columns < 1)
+            columns = 1;
+        if (rows < 1)
+            rows = 1;
+        cells.assign(columns * rows, vector<int>());
+        seen.assign(idCount, 0);
+        stamp = 0;
+        tick = Counters();
+        total = Counters();
+    }
+
+    void clear()
+    {
+        for (size_t i = 0; i < cells.size(); i++)
+            cells[i].clear();
+        tick = Counters();
+    }
+
+    void insert(int id, const SDL_Rect &rect)
+    {
+        int x0, y0, x1, y1;
+        cellRange(rect, x0, y0, x1, y1);
+        for (int y = y0; y <= y1; y++)
+            for (int x = x0; x <= x1; x++)
+                cells[y * columns + x].push_back(id);
+    }
+
+    // appends every id filed near the rectangle to out, each one once
+    void query(const SDL_Rect &rect, vector<int> &out)
+    {
+        if (++stamp == 0)
+        {
+            // the stamps wrapped around, forget every old one
+            seen.assign(seen.size(), 0);
+            stamp = 1;
+        }
+        int x0, y0, x1, y1;
+        cellRange(rect, x0, y0, x1, y1);
+        size_t first = out.size();
+        for (int y = y0; y <= y1; y++)
+            for (int x = x0; x <= x1; x++)
+            {
+                const vector<int> &cell = cells[y * columns + x];
+                for (size_t i = 0; i < cell.size(); i++)
+                {
+                    if (seen[cell[i]] == stamp)
+                        continue; // already found in a neighbouring cell
+                    seen[cell[i]] = stamp;
+                    out.push_back(cell[i]);
+                }
+            }
+        tick.queries++;
+        tick.candidatePairs += out.size() - first;
+        total.queries++;
+        total.candidatePairs += out.size() - first;
+    }
+
+    // since the last clear()
+    const Counters &tickCounters() const
+    {
+        return tick;
+    }
+
+    // since the last reset()
+    const Counters &totalCounters() const
+    {
+        return total;
+    }
+
+private:
+    int cellSize, columns, rows;
+    vector<vector<int>> cells; // row by row, the ids filed under each cell
+    vector<Uint32> seen;       // id -> stamp of the last query that returned it
+    Uint32 stamp;
+    Counters tick, total;
+
+    void cellRange(const SDL_Rect &rect, int &x0, int &y0, int &x1, int &y1) const
+    {
+        x0 = clampColumn(floorDiv(rect.x));
+        y0 = clampRow(floorDiv(rect.y));
+        x1 = clampColumn(floorDiv(rect.x + rect.w - 1));
+        y1 = clampRow(floorDiv(rect.y + rect.h - 1));
+    }
+
+    int floorDiv(int value) const
+    {
+        // enemies wait above the top edge, so coordinates can be negative
+        return value >= 0 ? value / cellSize : -((-value + cellSize - 1) / cellSize);
+    }
+
+    int clampColumn(int column) const
+    {
+        return column < 0 ? 0 : column >= columns ? columns - 1 : column;
+    }
+
+    int clampRow(int row) const
+    {
+        return row < 0 ? 0 : row >= rows ? rows - 1 : row;
+    }
+};
+
+#endif // SPATIAL_GRID_H
@@ -1,14 +1,15 @@
 #include "abstract.hpp"
+#include "snapshotBuffer.hpp"
+#include "spriteAtlas.hpp"
 #include <iostream>
 #include <cstdlib>
 #include <ctime>
 #include <vector>
-#include <SDL2\SDL.h>
-#include <SDL2\SDL_image.h>
-#include <SDL2\SDL_ttf.h>
-#include <SDL2\SDL_mixer.h>
-#include <SDL2\SDL_scancode.h>
-#include <random>
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <SDL2/SDL_ttf.h>
+#include <SDL2/SDL_mixer.h>
+#include <SDL2/SDL_scancode.h>
 #include <cmath>
 using namespace std;
 
@@ -29,18 +30,25 @@ const int POWERUP_SPAWN_DISTANCE = 300;
 class SpookyChase : virtual public Arcade
 {
 private:
-    SDL_Texture *backgroundTexture;
-    Mix_Chunk *collectSound;
-    Mix_Chunk *collisionSound;
-    Mix_Chunk *powerUpSound;
+    TextureHandle backgroundTexture;
+    SpriteAtlas atlas;             // Grim, the ghosts, the collectibles and the power-ups in one texture
+    AtlasSprite grimSprite;
+    AtlasSprite ghostSprite;       // shared by every obstacle
+    AtlasSprite collectibleSprite; // shared by every collectible
+    AtlasSprite powerUpSprite;     // shared by every power-up
+    int collectSound;   // ids in the session's sound effects
+    int collisionSound;
+    int powerUpSound;
     SDL_Rect backgroundRect;
     bool quit;
+    int lives;
+    int points;
+    int frameCount; // ticks played, power-ups are spawned every SPAWN_INTERVAL ticks
     struct Grim
     {
         int x;
         int y;
         int velocity;
-        SDL_Texture *texture;
     };
 
     struct Obstacle
@@ -48,7 +56,6 @@ private:
         int x;
         int y;
         int velocity;
-        SDL_Texture *texture;
     };
 
     struct PowerUp
@@ -57,9 +64,8 @@ private:
         int y;
         string type;
         bool collected;
-        int duration; // Duration in frames
+        int duration; // Duration in ticks
         int timer;    // Timer for tracking the duration
-        SDL_Texture *texture;
     };
 
     struct Collectible
@@ -70,10 +76,37 @@ private:
         float radius;
         bool collected;
         int velocity;
-        SDL_Texture *texture;
     };
+
+    // what the player asks for, read from the devices by pollInput() and acted on by handleEvents()
+    struct Controls
+    {
+        bool left = false, right = false, up = false, down = false;
+        bool leave = false; // Escape or the window was closed, stays set
+    };
+
+    // everything render() draws, copied from the game state after every tick
+    struct Scene
+    {
+        SDL_Rect grim;
+        vector<SDL_Rect> ghosts, collectibles, powerUps; // only the ones on screen
+        int lives = MAX_LIVES, points = 0;
+        const char *powerUpText = nullptr; // the power-up in effect, if any
+    };
+
+    Grim grim;
+    vector<Obstacle> obstacles;
+    vector<Collectible> collectibles;
+    vector<PowerUp> powerUps;
+    Controls controls;              // owned by the main thread
+    SnapshotBuffer<Controls> input; // main thread to simulation
+    SnapshotBuffer<Scene> scenes;   // simulation to main thread
+
     bool initialize()
     {
+        if (isHeadless() && !renderer)
+            return true; // no renderer or audio device to load textures and sounds for
+
         backgroundTexture = loadTexture("images/backgroundSpook.jpg");
         if (!backgroundTexture)
         {
@@ -81,14 +114,31 @@ private:
             return false;
         }
 
+        // obstacles, collectibles and power-ups are spawned during the game, so their sprites are packed once here,
+        // at the size they are drawn
+        int grimId = atlas.add("images/grimSpook.png", false, GRIM_WIDTH, GRIM_HEIGHT);
+        int ghost = atlas.add("images/ghosts.png", false, OBSTACLE_WIDTH, OBSTACLE_HEIGHT);
+        int collectible = atlas.add("images/collectible.png", false, COLLECTIBLE_WIDTH, COLLECTIBLE_HEIGHT);
+        int powerUp = atlas.add("images/powerup.png", false, COLLECTIBLE_WIDTH, COLLECTIBLE_HEIGHT);
+        bool packed = atlas.build(renderer);
+        grimSprite = atlas.sprite(grimId);
+        ghostSprite = atlas.sprite(ghost);
+        collectibleSprite = atlas.sprite(collectible);
+        powerUpSprite = atlas.sprite(powerUp);
+        if (!packed)
+            return false;
+
         backgroundRect = {0, 0, WINDOW_WIDTH, WINDOW_HEIGHT};
-        SDL_RenderCopy(renderer, backgroundTexture, nullptr, &backgroundRect);
+        SDL_RenderCopy(renderer, backgroundTexture.get(), nullptr, &backgroundRect);
+        if (isHeadless())
+            return true; // no audio device to load sounds for
         // Load music and sound effects
-        backgroundMusic = Mix_LoadMUS("sound/horrorBg.mp3");
-        collectSound = Mix_LoadWAV("sound/points.wav");
-        collisionSound = Mix_LoadWAV("sound/collision.wav");
-        powerUpSound = Mix_LoadWAV("sound/powerupSound.wav");
-        if (!backgroundMusic || !collectSound || !collisionSound || !powerUpSound)
+        backgroundMusic = loadMusic("sound/horrorBg.mp3");
+        // losing a life must be heard, the points jingle can give way to it
+        collectSound = sounds.load("sound/points.wav", SoundEffects::Low, 2);
+        collisionSound = sounds.load("sound/collision.wav", SoundEffects::High, 2);
+        powerUpSound = sounds.load("sound/powerupSound.wav", SoundEffects::Normal, 1);
+        if (!backgroundMusic || collectSound < 0 || collisionSound < 0 || powerUpSound < 0)
         {
             cout << "Failed to load audio files: " << Mix_GetError() << endl;
             return false;
@@ -99,98 +149,67 @@ private:
 
     void cleanup()
     {
-        Mix_FreeChunk(collectSound);
-        Mix_FreeChunk(collisionSound);
-        Mix_FreeChunk(powerUpSound);
+        // textures are shared handles, dropping the last one releases the texture
+        backgroundTexture.reset();
+        atlas.clear();
+        obstacles.clear();
+        collectibles.clear();
+        powerUps.clear();
     }
 
     void renderText(const string &text, int x, int y, const SDL_Color &color)
     {
-        SDL_Surface *surface = TTF_RenderText_Solid(font, text.c_str(), color);
-        if (!surface)
-        {
-            cout << "Failed to render text surface: " << TTF_GetError() << endl;
-            return;
-        }
-
-        SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
-        SDL_FreeSurface(surface);
-        if (!texture)
-        {
-            cout << "Failed to create text texture: " << SDL_GetError() << endl;
-            return;
-        }
-
-        int textWidth = 0;
-        int textHeight = 0;
-        SDL_QueryTexture(texture, nullptr, nullptr, &textWidth, &textHeight);
-
-        SDL_Rect dstRect = {x, y, textWidth, textHeight};
-        SDL_RenderCopy(renderer, texture, nullptr, &dstRect);
-        SDL_DestroyTexture(texture);
+        // glyphs come from the font's atlas, nothing is rasterized or uploaded here
+        textRenderer.draw(font, text, x, y, color);
     }
 
-    SDL_Texture *loadTexture(const string &fileName)
+    TextureHandle loadTexture(const string &fileName)
     {
-        SDL_Surface *surface = IMG_Load(fileName.c_str());
-        if (!surface)
-        {
-            cout << "Failed to load image: " << IMG_GetError() << endl;
-            return nullptr;
-        }
-
-        SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
-        SDL_FreeSurface(surface);
-
-        if (!texture)
-        {
-            cout << "Failed to create texture: " << SDL_GetError() << endl;
-            return nullptr;
-        }
-
-        return texture;
+        // the image is decoded only once through the shared cache
+        return assets.acquire(fileName);
     }
-    void handleEvents()
+    void pollInput()
     {
+        // on the main thread, the simulation may run on another one and only sees the controls
         SDL_Event event;
         while (SDL_PollEvent(&event))
         {
             if (event.type == SDL_QUIT)
             {
-                quit = true;
+                requestQuit(); // closing the window closes the arcade, not just this game
+                controls.leave = true;
             }
             else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_ESCAPE)
             {
-                quit = true; // Set the quit member variable to true when Escape key is pressed
-            }
-            // Play sound effects for specific events
-            if (event.type == SDL_USEREVENT)
-            {
-                if (event.user.code == 0) // Collect sound event
-                {
-                    Mix_PlayChannel(-1, collectSound, 0);
-                }
-                else if (event.user.code == 1) // Collision sound event
-                {
-                    Mix_PlayChannel(-1, collisionSound, 0);
-                }
-                else if (event.user.code == 2) // Power-up sound event
-                {
-                    Mix_PlayChannel(-1, powerUpSound, 0);
-                }
+                controls.leave = true; // the game ends when Escape key is pressed
             }
         }
+        const Uint8 *currentKeyStates = keyboardState();
+        controls.left = currentKeyStates[SDL_SCANCODE_LEFT] != 0;
+        controls.right = currentKeyStates[SDL_SCANCODE_RIGHT] != 0;
+        controls.up = currentKeyStates[SDL_SCANCODE_UP] != 0;
+        controls.down = currentKeyStates[SDL_SCANCODE_DOWN] != 0;
+        input.draft() = controls;
+        input.publish(FrameProfiler::now());
+    }
+
+    void handleEvents()
+    {
+        // the controls of the newest pollInput(), updateGrim() moves by them
+        input.acquire();
+        if (input.latest().leave)
+            quit = true; // Set the quit member variable to true when Escape key is pressed
     }
 
     void updateGrim(Grim &grim)
     {
         // updates the position of the Grim character based on keyboard input.
-        // It checks the state of keyboard keys using SDL_GetKeyboardState and moves the character accordingly.
+        // It checks the arrow keys of the newest controls and moves the character accordingly.
         // The Grim character cannot move outside the game window boundaries.
 
-        const Uint8 *currentKeyStates = SDL_GetKeyboardState(NULL);
+        const Controls &held = input.latest();
 
-        if (currentKeyStates[SDL_SCANCODE_LEFT])
+        if (held.left)
         {
             // subtracts the velocity value from the x coordinate of the grim character,
             //  causing it to move left.Additionally, it checks if the x coordinate goes below 0
@@ -204,7 +223,7 @@ private:
                 grim.x = 0;
             }
         }
-        else if (currentKeyStates[SDL_SCANCODE_RIGHT])
+        else if (held.right)
         {
             // it adds the velocity value to the x coordinate of the grim character,
             // causing it to move right.Additionally, it checks if the x coordinate exceeds the window width
@@ -218,7 +237,7 @@ private:
             }
         }
 
-        if (currentKeyStates[SDL_SCANCODE_UP])
+        if (held.up)
         {
             // it subtracts the velocity value from the y coordinate of the grim character,
             //  causing it to move up.Additionally, it checks if the y coordinate goes below 0(the top boundary of the game window) and,
@@ -229,7 +248,7 @@ private:
                 grim.y = 0;
             }
         }
-        else if (currentKeyStates[SDL_SCANCODE_DOWN])
+        else if (held.down)
         {
             // it adds the velocity value to the y coordinate of the grim character, causing it to move down.Additionally,
             // it checks if the y coordinate exceeds the window height minus the height of the Grim character(GRIM_HEIGHT).
@@ -266,24 +285,16 @@ private:
                 {
                     collectible.collected = true;
                     points += POINTS_PER_COLLECTIBLE;
-
-                    SDL_Event soundEvent;
-                    soundEvent.type = SDL_USEREVENT;
-                    soundEvent.user.code = 0;
-                    SDL_PushEvent(&soundEvent);
+                    sounds.play(collectSound);
 
                     // Move the collectible to a new random position on the screen
-                    collectible.x = rand() % (WINDOW_WIDTH - COLLECTIBLE_WIDTH);
-                    collectible.y = rand() % (WINDOW_HEIGHT - COLLECTIBLE_HEIGHT);
+                    collectible.x = rng.below(WINDOW_WIDTH - COLLECTIBLE_WIDTH);
+                    collectible.y = rng.below(WINDOW_HEIGHT - COLLECTIBLE_HEIGHT);
                     collectible.collected = false;
                 }
 
                 // Update the angle for the circular animation
                 collectible.angle += static_cast<float>(collectible.velocity);
-
-                // Render the collectible on the screen
-                SDL_Rect collectibleRect = {collectible.x, collectible.y, COLLECTIBLE_WIDTH, COLLECTIBLE_HEIGHT};
-                SDL_RenderCopy(renderer, collectible.texture, nullptr, &collectibleRect);
             }
         }
     }
@@ -303,22 +314,19 @@ private:
                 lives--; // Decrement lives on collision with an obstacle
 
                 // Reset the position of the obstacle
-                obstacle.x = rand() % (WINDOW_WIDTH - OBSTACLE_WIDTH);
-                obstacle.y = -(rand() % 1000 + 100);
-                obstacle.velocity = rand() % 5 + 1;
-
-                SDL_Event soundEvent;
-                soundEvent.type = SDL_USEREVENT;
-                soundEvent.user.code = 1;
-                SDL_PushEvent(&soundEvent);
+                obstacle.x = rng.below(WINDOW_WIDTH - OBSTACLE_WIDTH);
+                obstacle.y = -(rng.below(1000) + 100);
+                obstacle.velocity = rng.below(5) + 1;
+
+                sounds.play(collisionSound);
             }
 
             // Reset the position of the obstacle when it goes off the screen
             if (obstacle.y > WINDOW_HEIGHT)
             {
-                obstacle.x = rand() % (WINDOW_WIDTH - OBSTACLE_WIDTH);
-                obstacle.y = -(rand() % 1000 + 100);
-                obstacle.velocity = rand() % 5 + 1;
+                obstacle.x = rng.below(WINDOW_WIDTH - OBSTACLE_WIDTH);
+                obstacle.y = -(rng.below(1000) + 100);
+                obstacle.velocity = rng.below(5) + 1;
             }
         }
     }
@@ -340,11 +348,7 @@ private:
                     powerUp.collected = true;
                     powerUp.timer = powerUp.duration; // Start the timer for the power-up
 
-                    // Dispatch power-up sound event
-                    SDL_Event soundEvent;
-                    soundEvent.type = SDL_USEREVENT;
-                    soundEvent.user.code = 2;
-                    SDL_PushEvent(&soundEvent);
+                    sounds.play(powerUpSound);
 
                     if (powerUp.type == "SpeedBoost")
                     {
@@ -355,9 +359,6 @@ private:
                         lives = MAX_LIVES; // Set lives to the maximum value
                     }
                 }
-
-                SDL_Rect powerUpRect = {powerUp.x, powerUp.y, COLLECTIBLE_WIDTH, COLLECTIBLE_HEIGHT};
-                SDL_RenderCopy(renderer, powerUp.texture, nullptr, &powerUpRect);
             }
             else
             {
@@ -383,25 +384,16 @@ private:
             }
         }
     }
-    void renderPowerUpType(SDL_Renderer *renderer, TTF_Font *font, const string &powerUpType, int windowWidth, int windowHeight)
+    void renderPowerUpType(TTF_Font *font, const string &powerUpType, int windowWidth, int windowHeight)
     {
-        SDL_Color textColor = {255, 0, 0}; // Red color
-        SDL_Surface *textSurface = TTF_RenderText_Solid(font, powerUpType.c_str(), textColor);
-        SDL_Texture *textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
+        SDL_Color textColor = {255, 0, 0, 255}; // Red color
 
-        int textWidth = textSurface->w;
-        int textHeight = textSurface->h;
-
-        SDL_Rect textRect;
-        textRect.x = (windowWidth - textWidth) / 2;   // Center the text horizontally
-        textRect.y = (windowHeight - textHeight) / 2; // Center the text vertically
-        textRect.w = textWidth;
-        textRect.h = textHeight;
-
-        SDL_RenderCopy(renderer, textTexture, nullptr, &textRect);
+        int textWidth = 0;
+        int textHeight = 0;
+        textRenderer.measure(font, powerUpType, &textWidth, &textHeight);
 
-        SDL_FreeSurface(textSurface);
-        SDL_DestroyTexture(textTexture);
+        // Center the text horizontally and vertically
+        textRenderer.draw(font, powerUpType, (windowWidth - textWidth) / 2, (windowHeight - textHeight) / 2, textColor);
     }
 
     void spawnPowerUp(vector<PowerUp> &powerUps)
@@ -409,16 +401,14 @@ private:
         if (powerUps.size() < NUM_POWERUPS)
         {
             PowerUp powerUp;
-            powerUp.x = rand() % (WINDOW_WIDTH - COLLECTIBLE_WIDTH);
+            powerUp.x = rng.below(WINDOW_WIDTH - COLLECTIBLE_WIDTH);
             powerUp.y = -COLLECTIBLE_HEIGHT;
             powerUp.collected = false;
             powerUp.duration = 300; // Duration of 300 frames
             powerUp.timer = 0;
-            powerUp.texture = IMG_LoadTexture(renderer, "images/powerup.png");
 
             // Randomly choose a power-up type
-            srand(time(NULL));
-            int powerUpType = rand() % 3;
+            int powerUpType = rng.below(3);
             if (powerUpType == 0)
             {
                 powerUp.type = "SpeedBoost";
@@ -431,218 +421,263 @@ private:
         }
     }
 
-public:
-    SpookyChase() : Arcade("SpookyChase", WINDOW_WIDTH, WINDOW_HEIGHT) {}
-    void run()
+    void update()
     {
-        if (!initialize())
-        {
-            cleanup();
-            return;
-        }
-        srand(static_cast<unsigned int>(time(nullptr)));
-        font = TTF_OpenFont("spooky.ttf", 44);
-
-        Grim grim;
-        grim.x = WINDOW_WIDTH / 2 - GRIM_WIDTH / 2;
-        grim.y = WINDOW_HEIGHT - GRIM_HEIGHT - 10;
-        grim.velocity = 5;
-        grim.texture = loadTexture("images/grimSpook.png");
-        if (!grim.texture)
-        {
-            cleanup();
-            return;
-        }
-
-        vector<Obstacle> obstacles;
-        vector<Collectible> collectibles;
-        vector<PowerUp> powerUps;
-
-        int lives = MAX_LIVES;
-        int points = 0;
-
-        // Play background music on loop
-        Mix_PlayMusic(backgroundMusic, -1);
-
-        quit = false;
-        SDL_Event event;
-        int frameCount = 0;
-        const int SPAWN_INTERVAL = 200; // Adjust as needed 
-        int powerUpTimer = 0;
+        // one simulation tick: spawning, movement and collisions, everything is drawn in render()
+        const int SPAWN_INTERVAL = 200; // Adjust as needed
 
-        while (!quit)
+        if (lives > 0 && points < WINNING_POINTS)
         {
-            handleEvents();
-
-            SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-            SDL_RenderClear(renderer);
-
-            backgroundRect = {0, 0, WINDOW_WIDTH, WINDOW_HEIGHT};
-            SDL_RenderCopy(renderer, backgroundTexture, nullptr, &backgroundRect);
+            if (obstacles.empty())
+            {
+                Obstacle obstacle;
+                obstacle.x = rng.below(WINDOW_WIDTH - OBSTACLE_WIDTH);
+                obstacle.y = -OBSTACLE_HEIGHT;
+                obstacle.velocity = rng.below(3) + 1;
+                obstacles.push_back(obstacle);
+            }
+            if (collectibles.empty())
+            {
+                Collectible collectible;
+                collectible.x = rng.below(WINDOW_WIDTH - COLLECTIBLE_WIDTH);
+                collectible.y = rng.below(WINDOW_HEIGHT - COLLECTIBLE_HEIGHT);
+                collectible.collected = false;
+                collectible.velocity = rng.below(4) + 2; // Assign a random velocity
+                collectibles.push_back(collectible);
+            }
 
-            if (lives > 0 && points < WINNING_POINTS)
+            if (powerUps.empty())
             {
-                if (obstacles.empty())
+                PowerUp powerUp;
+                powerUp.x = rng.below(WINDOW_WIDTH - COLLECTIBLE_WIDTH);
+                powerUp.y = -COLLECTIBLE_HEIGHT;
+                powerUp.collected = false;
+                powerUp.duration = 300; // Duration of 300 ticks
+                powerUp.timer = 0;
+    
+                // Randomly choose a power-up type
+                int powerUpType = rng.below(3);
+                if (powerUpType == 0)
                 {
-                    Obstacle obstacle;
-                    obstacle.x = rand() % (WINDOW_WIDTH - OBSTACLE_WIDTH);
-                    obstacle.y = -OBSTACLE_HEIGHT;
-                    obstacle.velocity = rand() % 3 + 1;
-                    obstacle.texture = loadTexture("images/ghosts.png");
-                    if (!obstacle.texture)
-                    {
-                        cleanup();
-                        return;
-                    }
-                    obstacles.push_back(obstacle);
+                    powerUp.type = "SpeedBoost";
                 }
-                if (collectibles.empty())
+                else if (powerUpType == 1)
                 {
-                    Collectible collectible;
-                    collectible.x = rand() % (WINDOW_WIDTH - COLLECTIBLE_WIDTH);
-                    collectible.y = rand() % (WINDOW_HEIGHT - COLLECTIBLE_HEIGHT);
-                    collectible.collected = false;
-                    collectible.velocity = rand() % 4 + 2; // Assign a random velocity
-                    collectible.texture = loadTexture("images/collectible.png");
-                    if (!collectible.texture)
-                    {
-                        cleanup();
-                        return;
-                    }
-                    collectibles.push_back(collectible);
+                    powerUp.type = "Invincibility";
                 }
+                powerUps.push_back(powerUp);
+            }
 
-                if (powerUps.empty())
+            bool obstacleLeftScreen = false;
+            for (Obstacle &obstacle : obstacles)
+            {
+                obstacle.y += obstacle.velocity;
+                if (obstacle.y > WINDOW_HEIGHT)
                 {
-                    PowerUp powerUp;
-                    powerUp.x = rand() % (WINDOW_WIDTH - COLLECTIBLE_WIDTH);
-                    powerUp.y = -COLLECTIBLE_HEIGHT;
-                    powerUp.collected = false;
-                    powerUp.duration = 300; // Duration of 300 frames 
-                    powerUp.timer = 0;
-                    powerUp.texture = IMG_LoadTexture(renderer, "images/powerup.png");
-
-                    // Randomly choose a power-up type
-                    int powerUpType = rand() % 3;
-                    if (powerUpType == 0)
-                    {
-                        powerUp.type = "SpeedBoost";
-                    }
-                    else if (powerUpType == 1)
-                    {
-                        powerUp.type = "Invincibility";
-                    }
-                    powerUps.push_back(powerUp);
+                    obstacleLeftScreen = true;
                 }
+            }
+            if (obstacleLeftScreen)
+            {
+                obstacles.clear(); // cleared after the loop, clearing while iterating would invalidate it
+            }
 
-                for (Obstacle &obstacle : obstacles)
-                {
-                    obstacle.y += obstacle.velocity;
-                    if (obstacle.y > WINDOW_HEIGHT)
-                    {
-                        obstacles.clear();
-                    }
+            for (Collectible &collectible : collectibles)
+            {
+                collectible.y += collectible.velocity;
 
-                    SDL_Rect obstacleRect = {obstacle.x, obstacle.y, OBSTACLE_WIDTH, OBSTACLE_HEIGHT};
-                    SDL_RenderCopy(renderer, obstacle.texture, nullptr, &obstacleRect);
+                // Reset the position of the collectible when it goes off the screen
+                if (collectible.y > WINDOW_HEIGHT)
+                {
+                    collectible.x = rng.below(WINDOW_WIDTH - COLLECTIBLE_WIDTH);
+                    collectible.y = -(rng.below(1000) + 100);
+                    collectible.collected = false;
                 }
+            }
 
-                for (Collectible &collectible : collectibles)
-                {
-                    collectible.y += collectible.velocity;
+            updateGrim(grim);
+            updateObstacles(obstacles, grim, lives);
+            updateCollectibles(collectibles, grim, points);
+            updatePowerUps(powerUps, grim, lives, obstacles);
 
-                    // Reset the position of the collectible when it goes off the screen
-                    if (collectible.y > WINDOW_HEIGHT)
-                    {
-                        collectible.x = rand() % (WINDOW_WIDTH - COLLECTIBLE_WIDTH);
-                        collectible.y = -(rand() % 1000 + 100);
-                        collectible.collected = false;
-                    }
+            // Periodically spawn power-ups randomly
+            if (frameCount % SPAWN_INTERVAL == 0)
+            {
+                spawnPowerUp(powerUps);
+            }
 
-                    if (!collectible.collected)
-                    {
-                        SDL_Rect collectibleRect = {collectible.x, collectible.y, COLLECTIBLE_WIDTH, COLLECTIBLE_HEIGHT};
-                        SDL_RenderCopy(renderer, collectible.texture, nullptr, &collectibleRect);
-                    }
-                }
+            frameCount++;
+        }
 
-                updateGrim(grim);
-                updateObstacles(obstacles, grim, lives);
-                updateCollectibles(collectibles, grim, points);
+        // Clear the power-ups vector when the game ends
+        if (lives == 0 || points == WINNING_POINTS)
+        {
+            powerUps.clear();
+        }
+    }
 
-                // updatePowerUps(powerUps, grim, lives, obstacles);
-                updatePowerUps(powerUps, grim, lives, obstacles);
+    void render()
+    {
+        // only the newest scene, the game state itself may be changing on the simulation thread meanwhile
+        const Scene &scene = scenes.latest();
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+        SDL_RenderClear(renderer);
 
-                // Periodically spawn power-ups randomly
-                if (frameCount % SPAWN_INTERVAL == 0)
-                {
-                    spawnPowerUp(powerUps);
-                }
+        backgroundRect = {0, 0, WINDOW_WIDTH, WINDOW_HEIGHT};
+        SDL_RenderCopy(renderer, backgroundTexture.get(), nullptr, &backgroundRect);
+
+        if (scene.lives > 0 && scene.points < WINNING_POINTS)
+        {
+            for (const SDL_Rect &obstacleRect : scene.ghosts)
+                sprites.draw(ghostSprite, obstacleRect); // batched, every sprite of the scene is in the atlas
 
-                renderText("Lives: " + to_string(lives), 10, 10, {255, 255, 0, 255});
-                renderText("Points: " + to_string(points), WINDOW_WIDTH - 140, 10, {255, 255, 0, 255});
+            for (const SDL_Rect &collectibleRect : scene.collectibles)
+                sprites.draw(collectibleSprite, collectibleRect);
 
-                SDL_Rect carRect = {grim.x, grim.y, GRIM_WIDTH, GRIM_HEIGHT};
-                SDL_RenderCopy(renderer, grim.texture, nullptr, &carRect);
+            for (const SDL_Rect &powerUpRect : scene.powerUps)
+                sprites.draw(powerUpSprite, powerUpRect);
+            sprites.flush();
+
+            renderText("Lives: " + to_string(scene.lives), 10, 10, {255, 255, 0, 255});
+            renderText("Points: " + to_string(scene.points), WINDOW_WIDTH - 140, 10, {255, 255, 0, 255});
+
+            sprites.draw(grimSprite, scene.grim);
+        }
+        else
+        {
+            string message;
+            SDL_Color color;
 
-                frameCount++;
+            if (scene.lives <= 0)
+            {
+                message = "YOU LOST!";
+                color = {0, 192, 192, 192};
             }
             else
             {
-                string message;
-                SDL_Color color;
+                message = "YOU WON!";
+                color = {0, 128, 192, 255};
+            }
 
-                if (lives <= 0)
-                {
-                    message = "YOU LOST!";
-                    color = {0, 192, 192, 192};
-                }
-                else
-                {
-                    message = "YOU WON!";
-                    color = {0, 128, 192, 255};
-                }
+            renderText(message, WINDOW_WIDTH / 2 - 50, WINDOW_HEIGHT / 2 - 20, color);
+            renderText("Final Points: " + to_string(scene.points), WINDOW_WIDTH / 2 - 70, WINDOW_HEIGHT / 2 + 20, color);
+            renderText("Best: " + to_string(max(scene.points, highScore())), WINDOW_WIDTH / 2 - 70, WINDOW_HEIGHT / 2 + 60, color);
+        }
 
-                renderText(message, WINDOW_WIDTH / 2 - 50, WINDOW_HEIGHT / 2 - 20, color);
-                renderText("Final Points: " + to_string(points), WINDOW_WIDTH / 2 - 70, WINDOW_HEIGHT / 2 + 20, color);
-            }
-            // Clear the power-ups vector when the game ends
-            if (lives == 0 || points == WINNING_POINTS)
+        // Render the power-up type on the game window
+        if (scene.powerUpText)
+        {
+            renderPowerUpType(font, scene.powerUpText, WINDOW_WIDTH, WINDOW_HEIGHT);
+        }
+    }
+
+    bool publishesSnapshots()
+    {
+        return true;
+    }
+
+    void publishSnapshot(Uint64 tickTime)
+    {
+        // the vectors of a scene slot keep their memory, so this only allocates while there are more things on screen
+        Scene &scene = scenes.draft();
+        scene.grim = {grim.x, grim.y, GRIM_WIDTH, GRIM_HEIGHT};
+        scene.ghosts.clear();
+        for (const Obstacle &obstacle : obstacles)
+            scene.ghosts.push_back({obstacle.x, obstacle.y, OBSTACLE_WIDTH, OBSTACLE_HEIGHT});
+        scene.collectibles.clear();
+        for (const Collectible &collectible : collectibles)
+            if (!collectible.collected)
+                scene.collectibles.push_back({collectible.x, collectible.y, COLLECTIBLE_WIDTH, COLLECTIBLE_HEIGHT});
+        scene.powerUps.clear();
+        bool anyPowerUpCollected = false;
+        for (const PowerUp &powerUp : powerUps)
+        {
+            if (!powerUp.collected)
+                scene.powerUps.push_back({powerUp.x, powerUp.y, COLLECTIBLE_WIDTH, COLLECTIBLE_HEIGHT});
+            else
+                anyPowerUpCollected = true;
+        }
+        // the text names the first power-up, whichever one was collected
+        scene.powerUpText = nullptr;
+        if (anyPowerUpCollected)
+        {
+            if (powerUps[0].type == "SpeedBoost")
             {
-                powerUps.clear();
+                scene.powerUpText = "Speed Boost";
             }
-            // Render the power-up type on the game window
-            bool anyPowerUpCollected = false;
-            for (const PowerUp &powerUp : powerUps)
+            else if (powerUps[0].type == "Invincibility")
             {
-                if (powerUp.collected)
-                {
-                    anyPowerUpCollected = true;
-                    break;
-                }
+                scene.powerUpText = "Invincibility";
             }
+        }
+        scene.lives = lives;
+        scene.points = points;
+        scenes.publish(tickTime);
+    }
 
-            if (anyPowerUpCollected)
-            {
-                string powerUpTypeText;
-                if (powerUps[0].type == "SpeedBoost")
-                {
-                    powerUpTypeText = "Speed Boost";
-                }
-                else if (powerUps[0].type == "Invincibility")
-                {
-                    powerUpTypeText = "Invincibility";
-                }
-                renderPowerUpType(renderer, font, powerUpTypeText, WINDOW_WIDTH, WINDOW_HEIGHT);
-            }
+    Uint64 acquireSnapshot()
+    {
+        scenes.acquire();
+        return scenes.latestStamp();
+    }
 
-            SDL_RenderPresent(renderer);
-        }
+    bool isRunning()
+    {
+        // a headless run stops at the end screen, there is nobody to press Escape
+        bool gameOver = lives <= 0 || points >= WINNING_POINTS;
+        return !quit && !(isHeadless() && gameOver);
+    }
 
-        for (PowerUp &powerUp : powerUps)
+    int entityCount()
+    {
+        // of the scene on screen, the game may be in the middle of a tick
+        const Scene &scene = scenes.latest();
+        return 1 + int(scene.ghosts.size() + scene.collectibles.size() + scene.powerUps.size());
+    }
+
+    Uint32 stateChecksum()
+    {
+        // field by field, the structs have padding (and a string) that is not state
+        StateHash hash;
+        hash.add(grim.x).add(grim.y).add(grim.velocity).add(lives).add(points);
+        for (const Obstacle &obstacle : obstacles)
+            hash.add(obstacle.x).add(obstacle.y).add(obstacle.velocity);
+        for (const Collectible &collectible : collectibles)
+            hash.add(collectible.x).add(collectible.y).add(collectible.angle).add(collectible.collected);
+        for (const PowerUp &powerUp : powerUps)
+            hash.add(powerUp.x).add(powerUp.y).add(powerUp.collected).add(powerUp.timer);
+        return hash.result();
+    }
+
+public:
+    SpookyChase() : Arcade("SpookyChase", WINDOW_WIDTH, WINDOW_HEIGHT), atlas(&archive()), collectSound(-1), collisionSound(-1), powerUpSound(-1) {}
+    void run()
+    {
+        if (!initialize())
         {
-            SDL_DestroyTexture(powerUp.texture);
+            cleanup();
+            return;
         }
+        seedRng(); // every spawn position and speed follows the run's seed
+        font = fonts().get("spooky.ttf", 44);
+
+        grim.x = WINDOW_WIDTH / 2 - GRIM_WIDTH / 2;
+        grim.y = WINDOW_HEIGHT - GRIM_HEIGHT - 10;
+        grim.velocity = 5;
+
+        obstacles.clear();
+        collectibles.clear();
+        powerUps.clear();
+        lives = MAX_LIVES;
+        points = 0;
+        frameCount = 0;
+
+        // Play background music on loop
+        Mix_PlayMusic(backgroundMusic, -1);
+
+        quit = false;
+        runLoop(); // runs until the player quits with Escape or closes the window
+        submitScore(points);
 
         cleanup();
     }
@@ -0,0 +1,244 @@
+#ifndef SPRITE_ATLAS_H
+#define SPRITE_ATLAS_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "assetArchive.hpp"
+#include "assetCache.hpp"
+using namespace std;
+
+// AtlasSprite is one image inside an atlas page: draw src of texture to show it.
+struct AtlasSprite
+{
+    SDL_Texture *texture;
+    SDL_Rect src;
+};
+
+// SpriteAtlas packs a game's sprites into one or a few large textures when the game loads, so the sprite batch
+// can draw a whole scene from one texture instead of switching textures for every kind of sprite.
+// Images are added with the size the game draws them at and scaled down once while packing; the games draw
+// with nearest-pixel sampling, so the sprites look the same as when they were scaled every frame.
+//
+//   int ship = atlas.add("images/player.png", true, 100, 100);
+//   atlas.build(renderer);
+//   sprites.draw(atlas.sprite(ship), destination);
+class SpriteAtlas
+{
+public:
+    enum
+    {
+        MaxPageSize = 2048, // smaller if the renderer says so
+        Padding = 1         // empty pixels between two sprites
+    };
+
+    SpriteAtlas(const AssetArchive *archive = nullptr) : archive(archive) {}
+
+    ~SpriteAtlas()
+    {
+        clear();
+    }
+
+    // queues an image for the next build(), keyed images get transparent white like AssetCache's;
+    // width and height are the size it is drawn at, 0 keeps the size of the image
+    int add(const string &path, bool colorKeyWhite = false, int width = 0, int height = 0)
+    {
+        Entry entry;
+        entry.path = path;
+        entry.keyed = colorKeyWhite;
+        entry.rect = {0, 0, width, height};
+        entry.page = -1;
+        entries.push_back(entry);
+        return int(entries.size()) - 1;
+    }
+
+    // loads and packs every queued image and uploads the pages; images that fail to load are left out
+    bool build(SDL_Renderer *renderer)
+    {
+        destroyPages();
+        if (!renderer)
+            return false;
+
+        SDL_RendererInfo info;
+        int limit = MaxPageSize;
+        if (SDL_GetRendererInfo(renderer, &info) == 0 && info.max_texture_width > 0)
+            limit = min(limit, min(info.max_texture_width, info.max_texture_height));
+
+        vector<SDL_Surface *> images(entries.size(), nullptr);
+        vector<int> order;
+        long long area = 0;
+        int widest = 0;
+        for (size_t i = 0; i < entries.size(); i++)
+        {
+            Entry &entry = entries[i];
+            entry.page = -1;
+            images[i] = load(entry);
+            if (!images[i])
+                continue;
+            if (entry.rect.w <= 0 || entry.rect.h <= 0)
+            {
+                entry.rect.w = images[i]->w;
+                entry.rect.h = images[i]->h;
+            }
+            if (entry.rect.w + Padding > limit || entry.rect.h + Padding > limit)
+            {
+                cout << "Sprite too large for the atlas: " << entry.path << endl;
+                continue;
+            }
+            area += (long long)(entry.rect.w + Padding) * (entry.rect.h + Padding);
+            widest = max(widest, entry.rect.w + Padding);
+            order.push_back(int(i));
+        }
+
+        // shelf packing, tallest first: sprites go left to right along a shelf as high as its first sprite
+        int pageWidth = 64;
+        while (pageWidth < limit && ((long long)pageWidth * pageWidth < area || pageWidth < widest))
+            pageWidth *= 2;
+        pageWidth = min(pageWidth, limit);
+        stable_sort(order.begin(), order.end(), TallerFirst(entries));
+
+        vector<int> pageHeights;
+        int x = 0, y = 0, shelf = 0;
+        for (size_t n = 0; n < order.size(); n++)
+        {
+            Entry &entry = entries[order[n]];
+            if (pageHeights.empty() || x + entry.rect.w > pageWidth)
+            {
+                // next shelf, or the next page when the shelf would not fit
+                y += shelf;
+                x = 0;
+                shelf = 0;
+                if (pageHeights.empty() || y + entry.rect.h > limit)
+                {
+                    pageHeights.push_back(0);
+                    y = 0;
+                }
+            }
+            entry.page = int(pageHeights.size()) - 1;
+            entry.rect.x = x;
+            entry.rect.y = y;
+            x += entry.rect.w + Padding;
+            shelf = max(shelf, entry.rect.h + Padding);
+            pageHeights.back() = max(pageHeights.back(), y + entry.rect.h);
+        }
+
+        bool complete = order.size() == entries.size();
+        for (size_t p = 0; p < pageHeights.size(); p++)
+        {
+            SDL_Surface *page = SDL_CreateRGBSurfaceWithFormat(0, pageWidth, pageHeights[p], 32, SDL_PIXELFORMAT_ARGB8888);
+            if (!page)
+            {
+                complete = false;
+                pages.push_back(nullptr);
+                continue;
+            }
+            for (size_t n = 0; n < order.size(); n++)
+            {
+                Entry &entry = entries[order[n]];
+                if (entry.page != int(p))
+                    continue;
+                SDL_Surface *image = images[order[n]];
+                SDL_SetSurfaceBlendMode(image, SDL_BLENDMODE_NONE); // copy the alpha as it is
+                if (image->w == entry.rect.w && image->h == entry.rect.h)
+                    SDL_BlitSurface(image, nullptr, page, &entry.rect);
+                else
+                    SDL_BlitScaled(image, nullptr, page, &entry.rect);
+            }
+            SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, page);
+            SDL_FreeSurface(page);
+            if (!texture)
+            {
+                cout << "Failed to create atlas texture: " << SDL_GetError() << endl;
+                complete = false;
+            }
+            else
+                SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+            pages.push_back(texture);
+        }
+
+        for (size_t i = 0; i < images.size(); i++)
+            SDL_FreeSurface(images[i]);
+        return complete;
+    }
+
+    // an empty sprite (nullptr texture) if the image could not be packed; the batch skips those
+    AtlasSprite sprite(int id) const
+    {
+        AtlasSprite sprite = {nullptr, {0, 0, 0, 0}};
+        if (id >= 0 && id < int(entries.size()) && entries[id].page >= 0)
+        {
+            sprite.texture = pages[entries[id].page];
+            sprite.src = entries[id].rect;
+        }
+        return sprite;
+    }
+
+    int pageCount() const
+    {
+        return int(pages.size());
+    }
+
+    void clear()
+    {
+        // the pages belong to the renderer, so this has to run before the renderer is destroyed
+        destroyPages();
+        entries.clear();
+    }
+
+private:
+    struct Entry
+    {
+        string path;
+        bool keyed;
+        SDL_Rect rect; // where the sprite is on its page, once built
+        int page;
+    };
+
+    struct TallerFirst
+    {
+        const vector<Entry> &entries;
+        TallerFirst(const vector<Entry> &e) : entries(e) {}
+        bool operator()(int a, int b) const
+        {
+            return entries[a].rect.h > entries[b].rect.h;
+        }
+    };
+
+    const AssetArchive *archive;
+    vector<Entry> entries;
+    vector<SDL_Texture *> pages;
+
+    SDL_Surface *load(const Entry &entry)
+    {
+        // the archive has the pixels decoded (and keyed) already; the result is ARGB8888 with white keyed out
+        string id = AssetCache::assetId(entry.path, entry.keyed);
+        SDL_Surface *surface = archive ? archive->surface(id) : nullptr;
+        if (!surface)
+        {
+            surface = IMG_Load(entry.path.c_str());
+            if (!surface)
+            {
+                cout << "Failed to load image: " << IMG_GetError() << endl;
+                return nullptr;
+            }
+            if (entry.keyed)
+                SDL_SetColorKey(surface, SDL_TRUE, SDL_MapRGB(surface->format, 255, 255, 255));
+        }
+        SDL_Surface *pixels = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0); // the color key becomes alpha
+        SDL_FreeSurface(surface);
+        return pixels;
+    }
+
+    void destroyPages()
+    {
+        for (size_t i = 0; i < pages.size(); i++)
+            if (pages[i])
+                SDL_DestroyTexture(pages[i]);
+        pages.clear();
+    }
+};
+
+#endif // SPRITE_ATLAS_H
@@ -0,0 +1,104 @@
+#ifndef SPRITE_BATCH_H
+#define SPRITE_BATCH_H
+
+#include <SDL2/SDL.h>
+#include <vector>
+#include "spriteAtlas.hpp"
+using namespace std;
+
+// SpriteBatch collects textured quads and draws each run of quads that share a texture with one
+// SDL_RenderGeometry call, instead of one SDL_RenderCopy call per sprite.
+// Quads are drawn in the order they were added; the pending run is drawn when the texture changes or on flush().
+// Anything drawn without the batch (text, rectangles, SDL_RenderCopy) has to come after a flush(),
+// or it ends up below the sprites that are still pending. Arcade flushes after every render().
+class SpriteBatch
+{
+public:
+    SpriteBatch() : renderer(nullptr), texture(nullptr), textureW(1), textureH(1), drawCalls(0), sprites(0) {}
+
+    void setRenderer(SDL_Renderer *r)
+    {
+        // pending quads belong to the old renderer, they are dropped rather than drawn
+        vertices.clear();
+        indices.clear();
+        texture = nullptr;
+        renderer = r;
+    }
+
+    // like SDL_RenderCopy(renderer, texture, src, &dst), src nullptr is the whole texture
+    void draw(SDL_Texture *spriteTexture, const SDL_Rect *src, const SDL_Rect &dst)
+    {
+        if (!renderer || !spriteTexture)
+            return;
+        if (spriteTexture != texture)
+        {
+            flush();
+            texture = spriteTexture;
+            SDL_QueryTexture(texture, nullptr, nullptr, &textureW, &textureH);
+        }
+
+        float s0 = 0, t0 = 0, s1 = 1, t1 = 1;
+        if (src)
+        {
+            s0 = float(src->x) / textureW;
+            t0 = float(src->y) / textureH;
+            s1 = float(src->x + src->w) / textureW;
+            t1 = float(src->y + src->h) / textureH;
+        }
+        float left = float(dst.x), top = float(dst.y), right = float(dst.x + dst.w), bottom = float(dst.y + dst.h);
+        const SDL_Color white = {255, 255, 255, 255};
+
+        int first = int(vertices.size());
+        vertices.push_back({{left, top}, white, {s0, t0}});
+        vertices.push_back({{right, top}, white, {s1, t0}});
+        vertices.push_back({{right, bottom}, white, {s1, t1}});
+        vertices.push_back({{left, bottom}, white, {s0, t1}});
+        int quad[6] = {first, first + 1, first + 2, first, first + 2, first + 3};
+        indices.insert(indices.end(), quad, quad + 6);
+        sprites++;
+    }
+
+    void draw(const AtlasSprite &sprite, const SDL_Rect &dst)
+    {
+        draw(sprite.texture, &sprite.src, dst);
+    }
+
+    void flush()
+    {
+        if (!vertices.empty())
+        {
+            SDL_RenderGeometry(renderer, texture, &vertices[0], int(vertices.size()), &indices[0], int(indices.size()));
+            drawCalls++;
+        }
+        vertices.clear();
+        indices.clear();
+        texture = nullptr; // the next draw asks for the size again, the texture may be gone by then
+    }
+
+    // SDL_RenderGeometry calls and sprites since the last resetCounters(), Arcade resets them every frame
+    int drawCallCount() const
+    {
+        return drawCalls;
+    }
+
+    int spriteCount() const
+    {
+        return sprites;
+    }
+
+    void resetCounters()
+    {
+        drawCalls = 0;
+        sprites = 0;
+    }
+
+private:
+    SDL_Renderer *renderer;
+    SDL_Texture *texture; // of the pending run
+    int textureW, textureH;
+    vector<SDL_Vertex> vertices; // reused between frames so batching does not allocate every frame
+    vector<int> indices;
+    int drawCalls, sprites;
+};
+
+#endif // SPRITE_BATCH_H
@@ -6,9 +6,49 @@
 #include <SDL2/SDL_mixer.h>
 #include <SDL2/SDL_ttf.h>
 #include <string>
+#include <vector>
 #include "abstract.hpp"
+#include "pressQueue.hpp"
+#include "snapshotBuffer.hpp"
+#include "tetrisBoard.hpp"
+#include "tetrisPieces.hpp"
+#include "tetrisBot.hpp"
 using namespace std;
-class Tetris : virtual public Arcade
+
+// what main sets before Tetris starts, the same for every board size
+struct TetrisSettings
+{
+	// "main --board tall" or "--board wide" plays on a larger board; each size is a game of its own,
+	// with its own high scores and recordings
+	enum Board
+	{
+		Classic, // 20 lines of 10 columns
+		Tall,	 // 26 lines of 10 columns
+		Wide	 // 20 lines of 24 columns
+	};
+	Board board = Classic;
+
+	// "main --bot" lets TetrisBot play instead of the keyboard, in a window or headless, to load-test the game
+	bool bot = false;
+	int botThreads = 0; // searching, the main thread included; 0 is one per core
+	TetrisBotWeights botWeights;
+
+	// "main --das 133 --arr 0": a held arrow key moves the piece once, again after autoShiftDelay milliseconds
+	// and then every autoRepeatRate milliseconds (0 slides it to the wall at once), timed by the game, not the OS
+	Uint32 autoShiftDelay = 167;
+	Uint32 autoRepeatRate = 33;
+
+	static TetrisSettings &current()
+	{
+		static TetrisSettings settings;
+		return settings;
+	}
+};
+
+// Tetris on a board of LineCount lines by ColCount columns. The size is part of the type, so the board, the
+// bot and the layout are all built for it; the window grows with the board and the blocks keep their size.
+template <int LineCount, int ColCount>
+class TetrisGame : virtual public Arcade
 {
 private:
 	enum
@@ -18,35 +58,100 @@ private:
 	};
 	enum
 	{
-		Lines = 20,
-		Cols = 10
+		Lines = LineCount,
+		Cols = ColCount
+	};
+	enum
+	{
+		FieldLeft = BlockW,								// the playfield, with a margin of a block on the left and below
+		FieldTop = 28,
+		PanelLeft = FieldLeft + Cols * BlockW,			// the next piece and the score, right of the playfield
+		PanelW = 238,
+		WindowW = PanelLeft + PanelW,					// 700 x 700 for the classic board
+		WindowH = FieldTop + (Lines + 1) * BlockH,
+		NextLabelBottom = 190,							// the "Next Block" label, the piece is drawn below it
+		NextLeft = PanelLeft + BlockW * 3 / 2,
+		NextTop = 8 * BlockH
 	};
+	typedef TetrisBoard<Lines, Cols> Board;
+	typedef TetrisBot<Board> Bot;
 	SDL_Texture *background = NULL, *blocks = NULL;
+	SDL_Texture *stack = NULL; // the settled blocks, drawn again only when a piece locks or lines clear
+	bool stackChanged = true;  // the main thread's, the texture has to be drawn again whatever the scene says
+	Uint32 stackDrawn = 0;	   // the stackVersion of the scene the texture shows
 	SDL_Rect srcR = {0, 0, BlockW, BlockH}, destR = {0, 0, BlockW, BlockH};
-	Mix_Chunk *rowCompletedSound;
-	SDL_Color textColor = {255, 255, 255}, gameOverColor = {255, 255, 255};
+	int rowCompletedSound = -1; // id in the session's sound effects
+	SDL_Color textColor = {255, 255, 255, 255}, gameOverColor = {255, 255, 255, 255};
 	SDL_Event e;
 
 	bool running = false;
-	int field[Lines][Cols] = {0}; // field[9][19]
-	static const int figures[7][4];
-	struct Point
-	{
-		int x, y;
-	} items[4], backup[4], upcomingItems[4];
+	bool gameOver = false;
+	Board field; // the settled blocks, one bit per cell
+	TetrisPiece piece, upcoming; // turned and moved through TetrisPieces' tables
+	typedef TetrisCell Point;
+	Point items[4], upcomingItems[4]; // their cells, for drawing
 	int color = 1, upcomingColor = 1;
-	int dx = 0;
-	bool rotate = false;
+	enum Action
+	{
+		PressLeft,
+		PressRight,
+		ReleaseLeft,
+		ReleaseRight,
+		Turn
+	};
+	struct Input
+	{
+		Uint32 time; // game time, see Arcade::eventTime()
+		Action action;
+	};
+	vector<Input> inputs; // what happened since the last tick, in order
+	struct KeyPress
+	{
+		Uint32 timestamp; // of the SDL event, the simulation turns it into game time
+		Action action;
+	};
+	// what the player asks for, read from the devices by pollInput() and acted on by handleEvents()
+	struct Controls
+	{
+		typename PressQueue<KeyPress>::List presses; // arrow keys going down and up, none may be lost
+		bool down = false;							  // held, the piece falls faster
+		bool leave = false;							  // Escape or the window was closed, stays set
+	};
+	// everything render() draws, copied from the game state after every tick
+	struct Scene
+	{
+		Board field;
+		Uint32 stackVersion = 0; // changes whenever the settled blocks do
+		Point items[4], upcomingItems[4];
+		int color = 1, upcomingColor = 1, score = 0;
+		bool gameOver = false;
+	};
+	Controls controls;				// owned by the main thread
+	PressQueue<KeyPress> presses;	// the key presses in controls, until the simulation took them
+	vector<KeyPress> pressed;		// the simulation's, the presses of the current tick
+	SnapshotBuffer<Controls> input; // main thread to simulation
+	SnapshotBuffer<Scene> scenes;	// simulation to main thread
+	Uint32 stackVersion = 1;		// counts the changes to the settled blocks
+	bool leftDown = false, rightDown = false; // the arrow keys as the events left them
+	int held = 0; // the direction that auto-shifts, -1 left, 1 right, 0 none
+	Uint32 nextShift = 0; // game time of its next shift
 	unsigned int delay = 300;
 	Uint32 startTime = 0, currentTime = 0;
 	int score = 0;
+	Bot *bot = nullptr;		   // only while TetrisSettings::current().bot
+	TetrisBotMove plan = {}; // where the bot steers the falling piece
 
 	void cleanup()
 	{
+		if (bot)
+			reportBot();
+		delete bot;
+		bot = nullptr;
+		if (stack)
+			SDL_DestroyTexture(stack);
+		stack = NULL;
 		SDL_DestroyTexture(blocks);
 		SDL_DestroyTexture(background);
-		SDL_DestroyRenderer(renderer);
-		Mix_FreeChunk(rowCompletedSound);
 	}
 
 	void setCurrentTime(Uint32 t)
@@ -55,12 +160,28 @@ private:
 		currentTime = t;
 	}
 
-	bool isrunning()
+	bool isRunning()
 	{
 		// checks if the game is still running
 		return running;
 	}
 
+	Uint32 stateChecksum()
+	{
+		// the settled blocks, the falling piece, the next one and the score
+		StateHash hash;
+		for (int i = 0; i < Lines; i++)
+		{
+			hash.add(field.row(i));
+			for (int j = 0; j < Cols; j++)
+				hash.add(Uint8(field.color(j, i)));
+		}
+		hash.add(score).add(color).add(upcomingColor).add(delay).add(held).add(nextShift);
+		for (int i = 0; i < 4; i++)
+			hash.add(items[i].x).add(items[i].y).add(upcomingItems[i].x).add(upcomingItems[i].y);
+		return hash.result();
+	}
+
 	bool initialize()
 	{
 		SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
@@ -72,22 +193,21 @@ private:
 				 << "IMG_Init() Error : " << IMG_GetError() << endl;
 				 return false;
 		}
-		SDL_Surface *loadSurf = IMG_Load("images/tetris_background.png");
+		SDL_Surface *loadSurf = loadSurface("images/tetris_background.png");
 		background = SDL_CreateTextureFromSurface(renderer, loadSurf);
 		SDL_FreeSurface(loadSurf);
-		loadSurf = IMG_Load("images/blocks.png");
+		loadSurf = loadSurface("images/blocks.png");
 		blocks = SDL_CreateTextureFromSurface(renderer, loadSurf);
-		backgroundMusic = Mix_LoadMUS("sound/tetris-sounds.mp3");
-		rowCompletedSound = Mix_LoadWAV("sound/success.mp3");
-		if (!backgroundMusic || !rowCompletedSound)
+		backgroundMusic = loadMusic("sound/tetris-sounds.mp3");
+		rowCompletedSound = sounds.load("sound/success.mp3", SoundEffects::High, 1); // a clear is a clear, a second one cuts in too late to matter
+		if ((!backgroundMusic || rowCompletedSound < 0) && !isHeadless())
 		{
 			cout << "Failed to load music: " << Mix_GetError() << endl;
 			return false;
 		}
 		SDL_FreeSurface(loadSurf);
-		TTF_Init();
-		font = TTF_OpenFont("Oswald-Bold.ttf", 30);
-		msgfont = TTF_OpenFont("Oswald-Bold.ttf", 100);
+		font = fonts().get("Oswald-Bold.ttf", 30);
+		msgfont = fonts().get("Oswald-Bold.ttf", 100);
 		if (font == NULL || msgfont == NULL)
 		{
 			cout << "Failed to load font!" << TTF_GetError() << endl;
@@ -102,162 +222,236 @@ private:
 	void firstTetrimino()
 	{
 		// Generate the first block at the start of the game
-		color = 1 + rand() % 7;
-		int n = rand() % 7;
-		for (int i = 0; i < 4; i++)
-		{
-			items[i].x = figures[n][i] % 4;
-			items[i].y = int(figures[n][i] / 4);
-		}
+		color = 1 + rng.below(7);
+		piece = TetrisPieces::spawn(rng.below(7));
+		TetrisPieces::cells(piece, items);
+		planMove();
 	}
 	void nextTetrimino()
 	{
 		// Generate the upcoming block
-		upcomingColor = 1 + rand() % 7;
-		int n = rand() % 7; //  2,6,5,4,
-		for (int i = 0; i < 4; i++)
-		{
-			upcomingItems[i].x = figures[n][i] % 4;		 // 2 2 1 0
-			upcomingItems[i].y = int(figures[n][i] / 4); // 0 1 1 1
-		}
+		upcomingColor = 1 + rng.below(7);
+		upcoming = TetrisPieces::spawn(rng.below(7));
+		TetrisPieces::cells(upcoming, upcomingItems); // items[i].x = 2 2 1 0, items[i].y = 0 1 1 1 for an L
 	}
 	void currentTetrimino()
 	{
 		// Generate the current falling block
 		color = upcomingColor;
-		for (int i = 0; i < 4; i++)
+		piece = upcoming;
+		TetrisPieces::cells(piece, items);
+		nextTetrimino();
+		planMove();
+	}
+	void planMove()
+	{
+		// the bot decides once per piece, knowing the next one like a player does;
+		// the piece spawns before gameplay() clears the lines the last one completed, the bot sees them gone
+		if (!bot)
+			return;
+		Board settled = field;
+		settled.clearLines();
+		plan = bot->choose(settled, piece.figure, upcoming.figure);
+	}
+	void steerBot()
+	{
+		// presses what a player would, a key at a time: rotate to the planned rotation, tap towards the column,
+		// then hold down; a wall kick may shift the piece while it turns, the taps after it make up for that
+		inputs.clear();
+		leftDown = rightDown = false;
+		held = 0;
+		if (!plan.found)
 		{
-			items[i].x = upcomingItems[i].x;
-			items[i].y = upcomingItems[i].y;
+			delay = 50;
+			return;
 		}
-		nextTetrimino();
+		Uint32 now = gameTime();
+		if (piece.rotation != plan.piece.rotation)
+			inputs.push_back(Input{now, Turn});
+		if (plan.piece.x != piece.x)
+		{
+			bool left = plan.piece.x < piece.x;
+			inputs.push_back(Input{now, left ? PressLeft : PressRight});
+			inputs.push_back(Input{now, left ? ReleaseLeft : ReleaseRight});
+		}
+		if (inputs.empty())
+			delay = 50;
 	}
-	void handleEvents()
+	void reportBot()
 	{
-		// Handles keyboard input events, such as moving the tetrimino left or right and rotating it
+		double seconds = bot->searchSeconds();
+		cout << "Bot: " << bot->moveCount() << " pieces, " << bot->placementCount() << " placements scored in " << seconds
+			 << " s on " << bot->threadCount() << " threads (" << (seconds > 0 ? bot->placementCount() / seconds : 0)
+			 << " placements/s), score " << score << endl;
+	}
+	void pollInput()
+	{
+		// Reads the keyboard events on the main thread, such as moving the tetrimino left or right and rotating it;
+		// the simulation may run on another one and only sees the controls
 		while (SDL_PollEvent(&e))
 		{
 			switch (e.type)
 			{
 			case SDL_QUIT:
-				running = false;
+				requestQuit(); // closing the window closes the arcade, not just this game
+				controls.leave = true;
+				break;
+			case SDL_RENDER_TARGETS_RESET:
+				stackChanged = true; // some renderers lose what was drawn into target textures
 				break;
 			case SDL_KEYDOWN:
+				if (e.key.repeat)
+					break; // held keys repeat on the game's auto-shift timing, not the OS key repeat
 				switch (e.key.keysym.sym)
 				{
 				case SDLK_ESCAPE:
-					running = false;
+					controls.leave = true;
 					break;
 				case SDLK_UP:
-					rotate = true;
+					presses.push(KeyPress{e.key.timestamp, Turn});
 					break;
 				case SDLK_LEFT:
-					dx = -1;
+					presses.push(KeyPress{e.key.timestamp, PressLeft});
 					break;
 				case SDLK_RIGHT:
-					dx = 1;
+					presses.push(KeyPress{e.key.timestamp, PressRight});
 					break;
 				default:
 					break;
 				}
+				break;
+			case SDL_KEYUP:
+				if (e.key.keysym.sym == SDLK_LEFT)
+					presses.push(KeyPress{e.key.timestamp, ReleaseLeft});
+				else if (e.key.keysym.sym == SDLK_RIGHT)
+					presses.push(KeyPress{e.key.timestamp, ReleaseRight});
+				break;
 			default:
 				break;
 			}
 		}
-
-		const Uint8 *state = SDL_GetKeyboardState(NULL);
-		if (state[SDL_SCANCODE_DOWN])
+		controls.down = keyboardState()[SDL_SCANCODE_DOWN] != 0;
+		presses.publishTo(controls.presses);
+		input.draft() = controls;
+		input.publish(FrameProfiler::now());
+	}
+	void handleEvents()
+	{
+		// the controls of the newest pollInput(), with the presses that were not acted on yet in the order they came
+		input.acquire();
+		const Controls &held = input.latest();
+		if (held.leave)
+			running = false;
+		pressed.clear();
+		presses.take(held.presses, pressed);
+		for (size_t i = 0; i < pressed.size(); i++)
+			addInput(pressed[i].timestamp, pressed[i].action);
+		if (bot)
+			steerBot(); // the bot's moves replace the arrow keys
+		else if (held.down)
 			delay = 50;
 	}
-	bool isvalid()
+	void addInput(Uint32 timestamp, Action action)
 	{
-		// checks if the current tetrimino's position is valid within the game field
-		for (int i = 0; i < 4; i++) //  2 6 5 4
-			if (items[i].x < 0 || items[i].x >= Cols || items[i].y >= Lines)
-				return false;
-			else if (field[items[i].y][items[i].x]) // 0 1 1 1  // 2 2 1 0
-				return false;
+		// keeps the order of the events even if two timestamps round to the same game time
+		Uint32 time = eventTime(timestamp);
+		if (!inputs.empty() && time < inputs.back().time)
+			time = inputs.back().time;
+		inputs.push_back(Input{time, action});
+	}
+	bool shift(int direction)
+	{
+		TetrisPiece moved = piece;
+		moved.x += direction;
+		if (!TetrisPieces::fits(field, moved))
+			return false;
+		piece = moved;
 		return true;
 	}
-	void gameplay()
+	void autoShift(Uint32 until)
 	{
-		// backup
-		for (int i = 0; i < 4; i++)
-			backup[i] = items[i];
-		// move
-		if (dx)
+		// the shifts of the held arrow key that are due by then, however many fell into one tick
+		const TetrisSettings &settings = TetrisSettings::current();
+		while (held && nextShift <= until)
 		{
-			for (int i = 0; i < 4; i++)
+			if (!shift(held))
 			{
-				items[i].x += dx;
+				nextShift = until; // against a wall or a block it stays charged and moves as soon as there is room
+				return;
 			}
-			if (!isvalid())
-				for (int i = 0; i < 4; i++)
-					items[i] = backup[i];
+			nextShift += settings.autoRepeatRate;
 		}
-		// rotate
-		if (rotate)
-		{						//  2 6 5 4
-			Point p = items[2]; // center of rotation   // p.x = 1 , p.y = 1  ,items[i].x = 2 2 1 0 , items[i].y = 0 1 1 1
-			for (int i = 0; i < 4; i++)
+	}
+	void applyInput()
+	{
+		// every press and release of the tick at its own time, with the auto-shifts that came due before it
+		const TetrisSettings &settings = TetrisSettings::current();
+		for (size_t i = 0; i < inputs.size(); i++)
+		{
+			const Input &input = inputs[i];
+			autoShift(input.time);
+			switch (input.action)
 			{
-				int x = items[i].y - p.y; // -1 0 0  0
-				int y = items[i].x - p.x; //  1 1 0 -1
-				items[i].x = p.x - x;	  // 2 1 1 1
-				items[i].y = p.y + y;	  // 2 2 1 0
+			case PressLeft:
+			case PressRight:
+				// the last arrow pressed wins, it moves at once and auto-shifts after the delay
+				held = input.action == PressLeft ? -1 : 1;
+				(held < 0 ? leftDown : rightDown) = true;
+				shift(held);
+				nextShift = input.time + settings.autoShiftDelay;
+				break;
+			case ReleaseLeft:
+			case ReleaseRight:
+			{
+				int released = input.action == ReleaseLeft ? -1 : 1;
+				(released < 0 ? leftDown : rightDown) = false;
+				if (held != released)
+					break;
+				// the other arrow, if it is still down, takes over with a fresh delay
+				held = leftDown ? -1 : (rightDown ? 1 : 0);
+				nextShift = input.time + settings.autoShiftDelay;
+				break;
+			}
+			case Turn:
+				TetrisPieces::turn(field, piece); // with a wall kick if the turn does not fit where the piece is
+				break;
 			}
-			if (!isvalid())
-				for (int i = 0; i < 4; i++)
-					items[i] = backup[i];
 		}
+		inputs.clear();
+		autoShift(currentTime);
+	}
+	void gameplay()
+	{
+		// move and rotate
+		applyInput();
+		TetrisPieces::cells(piece, items);
 		// tick
 		if (currentTime - startTime > delay)
 		{
-			for (int i = 0; i < 4; i++)
-				backup[i] = items[i];
-			for (int i = 0; i < 4; i++)
-				items[i].y++;
-			if (!isvalid())
+			TetrisPiece fallen = piece;
+			fallen.y++;
+			if (TetrisPieces::fits(field, fallen))
+			{
+				piece = fallen;
+				TetrisPieces::cells(piece, items);
+			}
+			else
 			{
-				for (int i = 0; i < 4; i++)
-					field[backup[i].y][backup[i].x] = color;
+				field.place(items, color);
+				stackVersion++;
 				currentTetrimino();
 			}
 			startTime = currentTime;
 		}
 		// Check for completed lines
-		int completedLines = 0;
-		for (int i = 0; i < Lines; i++)
-		{
-			bool lineComplete = true;
-			for (int j = 0; j < Cols; j++)
-			{
-				if (field[i][j] == 0)
-				{
-					lineComplete = false;
-					break;
-				}
-			}
-			if (lineComplete)
-			{
-				completedLines++;
-				for (int j = i; j > 0; j--)
-				{
-					for (int k = 0; k < Cols; k++)
-					{
-						field[j][k] = field[j - 1][k];
-					}
-				}
-			}
-		}
+		int completedLines = field.clearLines();
 		// Update the score
 		if (completedLines > 0)
 		{
+			stackVersion++;
 			score += completedLines * 10;
-			Mix_PlayChannel(-1, rowCompletedSound, 0); // Play the row completed sound
+			sounds.play(rowCompletedSound); // Play the row completed sound
 		}
-		dx = 0;
-		rotate = false;
 		delay = 300;
 	}
 	void setRectPos(SDL_Rect &rect, int x = 0, int y = 0, int w = BlockW, int h = BlockH)
@@ -278,143 +472,207 @@ private:
 			while (SDL_PollEvent(&e))
 			{
 				if (e.type == SDL_QUIT)
-					running = false;
+				{
+					requestQuit();
+					break;
+				}
 			}
+			SDL_Delay(10); // waiting without keeping a core busy
 		}
 		running = false;
 	}
-	void renderUpcomingBlock()
+	void renderUpcomingBlock(const Scene &scene)
 	{
 		SDL_RenderCopy(renderer, background, NULL, NULL);
 		for (int i = 0; i < 4; i++)
-		{																									  // items[i].x = 2 2 1 0, items[i].y = 0 1 1 1
-			setRectPos(srcR, upcomingColor * BlockW);														  // 2 * 42 = 84
-			setRectPos(destR, (upcomingItems[i].x + Cols + 2.5) * BlockW, (upcomingItems[i].y + 8) * BlockH); // 609 609 567 525, 256 288 288 288
-			SDL_RenderCopy(renderer, blocks, &srcR, &destR);
+		{																												  // items[i].x = 2 2 1 0, items[i].y = 0 1 1 1
+			setRectPos(srcR, scene.upcomingColor * BlockW);																  // 2 * 42 = 84
+			setRectPos(destR, NextLeft + scene.upcomingItems[i].x * BlockW, NextTop + scene.upcomingItems[i].y * BlockH); // 609 609 567 525, 256 288 288 288
+			sprites.draw(blocks, &srcR, destR);
 		}
 	}
-	void renderGameField()
+	void drawStack(const Board &settled, int left, int top)
 	{
 		for (int i = 0; i < Lines; i++)
-			for (int j = 0; j < Cols; j++)
-				if (field[i][j])
-				{
-					setRectPos(srcR, field[i][j] * BlockW);	   // 42
-					setRectPos(destR, j * BlockW, i * BlockH); //
-					moveRectPos(destR, BlockW, Height - (Lines + 1) * BlockH);
-					SDL_RenderCopy(renderer, blocks, &srcR, &destR);
-				}
+			for (typename Board::Row row = settled.row(i); row; row &= row - 1) // only the occupied columns
+			{
+				int j = Board::lowestColumn(row);
+				setRectPos(srcR, settled.color(j, i) * BlockW);	   // 42
+				setRectPos(destR, j * BlockW, i * BlockH); //
+				moveRectPos(destR, left, top);
+				sprites.draw(blocks, &srcR, destR);
+			}
+	}
+	void updateStack(const Scene &scene)
+	{
+		// draws the settled blocks into their texture when they changed; this switches the render target,
+		// so it runs before anything else of the frame is drawn or batched
+		if (scene.stackVersion != stackDrawn)
+			stackChanged = true;
+		if (!stackChanged)
+			return;
+		if (!stack && SDL_RenderTargetSupported(renderer))
+		{
+			stack = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, Cols * BlockW, Lines * BlockH);
+			if (stack)
+				SDL_SetTextureBlendMode(stack, SDL_BLENDMODE_BLEND);
+		}
+		if (!stack)
+			return; // renderGameField() draws the blocks one by one every frame instead
+		Uint8 r, g, b, a;
+		SDL_GetRenderDrawColor(renderer, &r, &g, &b, &a);
+		SDL_SetRenderTarget(renderer, stack);
+		SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+		SDL_RenderClear(renderer);
+		drawStack(scene.field, 0, 0);
+		sprites.flush();
+		SDL_SetRenderTarget(renderer, NULL);
+		SDL_SetRenderDrawColor(renderer, r, g, b, a);
+		stackChanged = false;
+		stackDrawn = scene.stackVersion;
 	}
-	void renderFallingBlock()
+	void renderGameField(const Scene &scene)
+	{
+		if (!stack)
+		{
+			drawStack(scene.field, FieldLeft, FieldTop); // one batch with the other blocks
+			return;
+		}
+		SDL_Rect area = {FieldLeft, FieldTop, Cols * BlockW, Lines * BlockH};
+		sprites.draw(stack, NULL, area);
+	}
+	void renderFallingBlock(const Scene &scene)
 	{
 		for (int i = 0; i < 4; i++)
-		{																 // items[i].x = 2 2 1 0, items[i].y = 0 1 1 1
-			setRectPos(srcR, color * BlockW);							 // 2 * 42 = 84
-			setRectPos(destR, items[i].x * BlockW, items[i].y * BlockH); // 84 84 42 0, 0 32 32 32
-			moveRectPos(destR, BlockW, Height - (Lines + 1) * BlockH);	 // 42 , 700 - 21 * 32 = 28
-			SDL_RenderCopy(renderer, blocks, &srcR, &destR);
+		{																			 // items[i].x = 2 2 1 0, items[i].y = 0 1 1 1
+			setRectPos(srcR, scene.color * BlockW);									 // 2 * 42 = 84
+			setRectPos(destR, scene.items[i].x * BlockW, scene.items[i].y * BlockH); // 84 84 42 0, 0 32 32 32
+			moveRectPos(destR, FieldLeft, FieldTop);					 // 42 , 28
+			sprites.draw(blocks, &srcR, destR);
 		}
+		sprites.flush(); // every block of the frame in one draw call, before the text
 	}
-	void renderScore()
+	void renderScore(const Scene &scene)
 	{
-		string scoreText = "Score: " + to_string(score);
-		SDL_Surface *scoreSurface = TTF_RenderText_Solid(font, scoreText.c_str(), textColor);
-		SDL_Texture *scoreTexture = SDL_CreateTextureFromSurface(renderer, scoreSurface);
-		SDL_Rect scoreRect;
-		scoreRect.x = Width - scoreSurface->w - 40;	  // Adjust the position as needed
-		scoreRect.y = Height - scoreSurface->h - 100; // Adjust the position as needed
-		scoreRect.w = scoreSurface->w;
-		scoreRect.h = scoreSurface->h;
-		SDL_RenderCopy(renderer, scoreTexture, NULL, &scoreRect);
-		SDL_FreeSurface(scoreSurface);
-		SDL_DestroyTexture(scoreTexture);
+		string scoreText = "Score: " + to_string(scene.score);
+		int w, h;
+		textRenderer.measure(font, scoreText, &w, &h);
+		textRenderer.draw(font, scoreText, Width - w - 40, Height - h - 100, textColor); // Adjust the position as needed
+		string bestText = "Best: " + to_string(max(scene.score, highScore())); // from the score store, no file access here
+		textRenderer.measure(font, bestText, &w, &h);
+		textRenderer.draw(font, bestText, Width - w - 40, Height - h - 60, textColor);
 	}
 	void renderNextBlock()
 	{
 		string Text = "Next Block";
-		SDL_Surface *TextSurface = TTF_RenderText_Solid(font, Text.c_str(), textColor);
-		SDL_Texture *TextTexture = SDL_CreateTextureFromSurface(renderer, TextSurface);
-		SDL_Rect TextRect;
-		TextRect.x = Width - TextSurface->w - 36;	// Adjust the position as needed
-		TextRect.y = Height - TextSurface->h - 510; // Adjust the position as needed
-		TextRect.w = TextSurface->w;
-		TextRect.h = TextSurface->h;
-		SDL_RenderCopy(renderer, TextTexture, NULL, &TextRect);
-		SDL_FreeSurface(TextSurface);
-		SDL_DestroyTexture(TextTexture);
-	}
-	void renderGameOver()
-	{
-		// Check if the game is over
-		bool gameOver = false;
-		for (int i = 0; i < Cols; i++)
+		int w, h;
+		textRenderer.measure(font, Text, &w, &h);
+		textRenderer.draw(font, Text, Width - w - 36, NextLabelBottom - h, textColor); // Adjust the position as needed
+	}
+	void renderGameOver(const Scene &scene)
+	{
+		if (scene.gameOver)
 		{
-			if (field[0][i] != 0)
-			{
-				gameOver = true;
-				running = false;
-				break;
-			}
+			string gameOverText = "Game Over!";
+			int w, h;
+			textRenderer.measure(msgfont, gameOverText, &w, &h);
+			textRenderer.draw(msgfont, gameOverText, (Width - w) / 2, (Height - h) / 2, gameOverColor);
 		}
-		if (gameOver)
+	}
+	void update()
+	{
+		// one simulation tick, the drop timer runs on simulated time so pieces fall at the same speed everywhere
+		setCurrentTime(gameTime());
+		gameplay();
+		checkGameOver();
+	}
+	void checkGameOver()
+	{
+		// the game is over once the settled stack reaches the top row
+		if (field.reachedTop())
 		{
-			string gameOverText = "Game Over!";
-			SDL_Surface *gameOverSurface = TTF_RenderText_Solid(msgfont, gameOverText.c_str(), gameOverColor);
-			SDL_Texture *gameOverTexture = SDL_CreateTextureFromSurface(renderer, gameOverSurface);
-			SDL_Rect gameOverRect;
-			gameOverRect.x = (Width - gameOverSurface->w) / 2;
-			gameOverRect.y = (Height - gameOverSurface->h) / 2;
-			gameOverRect.w = gameOverSurface->w;
-			gameOverRect.h = gameOverSurface->h;
-			SDL_RenderCopy(renderer, gameOverTexture, NULL, &gameOverRect);
-			SDL_FreeSurface(gameOverSurface);
-			SDL_DestroyTexture(gameOverTexture);
+			gameOver = true;
+			running = false;
 		}
 	}
-	void updateRender()
+	void render()
 	{
-		renderUpcomingBlock();
-		renderGameField();
-		renderFallingBlock();
-		renderScore();
+		// the frame is presented by runLoop(); it only draws the newest scene, the game state itself may be
+		// changing on the simulation thread meanwhile
+		const Scene &scene = scenes.latest();
+		updateStack(scene);
+		renderUpcomingBlock(scene);
+		renderGameField(scene);
+		renderFallingBlock(scene);
+		renderScore(scene);
 		renderNextBlock();
-		renderGameOver();
-		SDL_RenderPresent(renderer);
+		renderGameOver(scene);
+	}
+	bool publishesSnapshots()
+	{
+		return true;
+	}
+	void publishSnapshot(Uint64 tickTime)
+	{
+		Scene &scene = scenes.draft();
+		if (scene.stackVersion != stackVersion)
+			scene.field = field; // the slot may still hold the same blocks from an earlier tick
+		scene.stackVersion = stackVersion;
+		for (int i = 0; i < 4; i++)
+		{
+			scene.items[i] = items[i];
+			scene.upcomingItems[i] = upcomingItems[i];
+		}
+		scene.color = color;
+		scene.upcomingColor = upcomingColor;
+		scene.score = score;
+		scene.gameOver = gameOver;
+		scenes.publish(tickTime);
+	}
+	Uint64 acquireSnapshot()
+	{
+		scenes.acquire();
+		return scenes.latestStamp();
 	}
 
 public:
-	Tetris() : Arcade("Tetris") {}
+	TetrisGame(const char *name) : Arcade(name, WindowW, WindowH) {}
 	void run()
 	{
-		srand(time(0));
+		seedRng(); // the piece sequence follows the run's seed
 		const char *title = "Tetris game";
+		const TetrisSettings &settings = TetrisSettings::current();
+		if (settings.bot)
+		{
+			bot = new Bot(settings.botThreads);
+			bot->setWeights(settings.botWeights);
+		}
 		if (initialize())
 		{
 			firstTetrimino();
-			while (isrunning())
-			{
-				setCurrentTime(SDL_GetTicks());
-				handleEvents();
-				gameplay();
-				updateRender();
-			}
+			runLoop();
+			submitScore(score);
 		}
-		delay_();
+		if (!isHeadless())
+			delay_();
 		cleanup();
 	}
 };
 
-/*
-	0	1	2	3
-	4	5	6	7
-*/
-const int Tetris::figures[7][4] =
-	{
-		0, 1, 2, 3, // I
-		0, 4, 5, 6, // J
-		2, 6, 5, 4, // L
-		1, 2, 5, 6, // O
-		2, 1, 5, 4, // S
-		1, 4, 5, 6, // T
-		0, 1, 5, 6, // Z
-};
\ No newline at end of file
+typedef TetrisGame<20, 10> Tetris;
+typedef TetrisGame<26, 10> TallTetris;
+typedef TetrisGame<20, 24> WideTetris;
+
+// the Tetris picked with "main --board"; the names keep the scores and recordings of each size apart
+inline Arcade *createTetris()
+{
+	switch (TetrisSettings::current().board)
+	{
+	case TetrisSettings::Tall:
+		return new TallTetris("TetrisTall");
+	case TetrisSettings::Wide:
+		return new WideTetris("TetrisWide");
+	default:
+		return new Tetris("Tetris");
+	}
+}
@@ -0,0 +1,159 @@
+#ifndef TETRIS_BOARD_H
+#define TETRIS_BOARD_H
+
+#include <SDL2/SDL.h>
+#include <cstring>
+#ifdef _MSC_VER
+#include <intrin.h> // _BitScanForward64
+#endif
+using namespace std;
+
+// TetrisCell is one cell of the playfield, x the column from the left and y the line from the top.
+struct TetrisCell
+{
+    int x, y;
+};
+
+// TetrisRowWord is the smallest unsigned integer with a bit for each of Cols columns.
+template <int Cols, bool Narrow = (Cols <= 16), bool Medium = (Cols <= 32)>
+struct TetrisRowWord
+{
+    typedef Uint64 Type;
+};
+
+template <int Cols, bool Medium>
+struct TetrisRowWord<Cols, true, Medium>
+{
+    typedef Uint16 Type;
+};
+
+template <int Cols>
+struct TetrisRowWord<Cols, false, true>
+{
+    typedef Uint32 Type;
+};
+
+// TetrisBoard is the playfield of settled blocks as bit planes: one word per line with a bit set for every
+// occupied column, and the colors in a separate byte plane that only rendering looks at.
+// A piece fits when none of its bits meets a line's word, a line is full when its word has every column bit
+// set, and clearing lines moves whole words down; no cell by cell loops are left in the game logic.
+// The size is part of the type, so every loop over the lines has a constant count the compiler can unroll,
+// and a board of up to 16 columns uses 16-bit words, up to 32 columns 32-bit words, up to 64 columns 64-bit.
+// Line 0 is the top; cells above it (y < 0) are open so a piece can rotate out of the spawn rows.
+// The pieces and the test whether one fits are in TetrisPieces.
+template <int LineCount, int ColCount>
+class TetrisBoard
+{
+public:
+    static_assert(LineCount >= 4 && ColCount >= 4, "a piece has to fit on the board");
+    static_assert(ColCount <= 64, "a line is one word of at most 64 bits");
+
+    enum
+    {
+        Lines = LineCount,
+        Cols = ColCount
+    };
+
+    typedef typename TetrisRowWord<Cols>::Type Row; // bit x is column x
+    static constexpr Row Full = Row(~Row(0)) >> (sizeof(Row) * 8 - Cols);
+
+    typedef TetrisCell Cell;
+
+    TetrisBoard()
+    {
+        clear();
+    }
+
+    void clear()
+    {
+        memset(rows, 0, sizeof(rows));
+        memset(colors, 0, sizeof(colors));
+    }
+
+    // settles a piece; cells above the top line are lost, the stack has reached the top by then anyway
+    void place(const Cell cells[4], int color)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            const Cell &cell = cells[i];
+            if (cell.y < 0 || cell.y >= Lines || unsigned(cell.x) >= unsigned(Cols))
+                continue;
+            rows[cell.y] |= bit(cell.x);
+            colors[cell.y][cell.x] = Uint8(color);
+        }
+    }
+
+    // removes the full lines and lets the ones above fall into their place, returns how many were removed
+    int clearLines()
+    {
+        // compacts from the bottom up: every line that is not full is copied to the next free slot
+        int to = Lines - 1;
+        for (int from = Lines - 1; from >= 0; from--)
+        {
+            if (rows[from] == Full)
+                continue;
+            if (to != from)
+            {
+                rows[to] = rows[from];
+                memcpy(colors[to], colors[from], Cols);
+            }
+            to--;
+        }
+        int cleared = to + 1;
+        for (; to >= 0; to--)
+        {
+            rows[to] = 0;
+            memset(colors[to], 0, Cols);
+        }
+        return cleared;
+    }
+
+    Row row(int y) const
+    {
+        return rows[y];
+    }
+
+    // 0 for an empty cell
+    int color(int x, int y) const
+    {
+        return colors[y][x];
+    }
+
+    bool reachedTop() const
+    {
+        return rows[0] != 0;
+    }
+
+    // occupied columns in a line's word
+    static int countColumns(Row row)
+    {
+        Uint64 bits = row;
+        bits = bits - ((bits >> 1) & 0x5555555555555555ULL);
+        bits = (bits & 0x3333333333333333ULL) + ((bits >> 2) & 0x3333333333333333ULL);
+        bits = (bits + (bits >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        return int((bits * 0x0101010101010101ULL) >> 56);
+    }
+
+    // the first occupied column of a line's word, which must not be 0
+    static int lowestColumn(Row row)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, (unsigned __int64)row);
+        return int(index);
+#else
+        return __builtin_ctzll(row);
+#endif
+    }
+
+private:
+    Row rows[Lines];
+    Uint8 colors[Lines][Cols];
+
+    static Row bit(int x)
+    {
+        return Row(Row(1) << x);
+    }
+};
+
+#endif // TETRIS_BOARD_H
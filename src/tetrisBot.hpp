@@ -0,0 +1,269 @@
+#ifndef TETRIS_BOT_H
+#define TETRIS_BOT_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_atomic.h>
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+#include "tetrisBoard.hpp"
+#include "tetrisPieces.hpp"
+using namespace std;
+
+// TetrisBotWeights tune how the bot scores a board, the same for every board size.
+struct TetrisBotWeights
+{
+    double height = -0.510066;    // sum of the column heights
+    double lines = 0.760666;      // lines cleared by both pieces
+    double holes = -0.35663;      // empty cells with a block above them
+    double bumpiness = -0.184483; // sum of the height differences of neighbouring columns
+};
+
+// TetrisBotMove is where the bot puts a piece, turned and dropped; found is false when no placement fits at all.
+struct TetrisBotMove
+{
+    bool found;
+    TetrisPiece piece;
+    double score;
+};
+
+// TetrisBot picks where a piece should go: it tries every rotation in every column of the falling piece, and
+// for each of those every rotation and column of the next piece, dropped straight down, and keeps the
+// placement whose best follow-up leaves the board with the highest score. Rotations that look like an earlier
+// one (the O piece turned, the I, S and Z turned twice) are skipped, TetrisPieces marks them.
+// A board is scored by a weighted sum of the lines cleared on the way, the height of its columns, the holes
+// under them and how uneven they are, with the weights of Yiyuan Lee's well known Tetris AI by default.
+//
+// The first placements are shared out among a pool of SDL threads; each one takes the next placement from
+// an atomic counter and searches all of its follow-ups, so a move costs one hand-off to the pool. The result
+// does not depend on the number of threads: scores are kept per placement and ties go to the first one.
+// Board is a TetrisBoard, the bot is built for one board size like the game.
+template <class Board>
+class TetrisBot
+{
+public:
+    typedef TetrisBotWeights Weights;
+    typedef TetrisBotMove Move;
+    typedef typename Board::Row Row;
+
+    // threads counts the caller, which searches too; 0 uses one thread per core
+    TetrisBot(int threads = 0) : board(nullptr), follower(0), placements(0), moves(0), searchTicks(0)
+    {
+        if (threads <= 0)
+            threads = SDL_GetCPUCount();
+        SDL_AtomicSet(&nextJob, 0);
+        SDL_AtomicSet(&evaluated, 0);
+        stopping = false;
+        for (int f = 0; f < TetrisPieces::Figures; f++)
+            placementsOf(f, followTable[f]);
+        startWork = SDL_CreateSemaphore(0);
+        workDone = SDL_CreateSemaphore(0);
+        for (int i = 1; i < threads && startWork && workDone; i++)
+        {
+            SDL_Thread *worker = SDL_CreateThread(searchWorker, "tetris bot", this);
+            if (!worker)
+                break;
+            workers.push_back(worker);
+        }
+    }
+
+    ~TetrisBot()
+    {
+        stopping = true;
+        for (size_t i = 0; i < workers.size(); i++)
+            SDL_SemPost(startWork);
+        for (size_t i = 0; i < workers.size(); i++)
+            SDL_WaitThread(workers[i], nullptr);
+        if (startWork)
+            SDL_DestroySemaphore(startWork);
+        if (workDone)
+            SDL_DestroySemaphore(workDone);
+    }
+
+    void setWeights(const Weights &w)
+    {
+        weights = w;
+    }
+
+    // the best place for a new piece of figure on field, looking one piece ahead at the next figure
+    Move choose(const Board &field, int figure, int nextFigure)
+    {
+        Uint64 started = SDL_GetPerformanceCounter();
+        board = &field;
+        follower = nextFigure;
+        jobs.clear();
+        placementsOf(figure, jobs);
+        results.assign(jobs.size(), Result());
+
+        // the workers wake up, take jobs until none are left and report back; the semaphores order the memory
+        SDL_AtomicSet(&nextJob, 0);
+        for (size_t i = 0; i < workers.size(); i++)
+            SDL_SemPost(startWork);
+        work();
+        for (size_t i = 0; i < workers.size(); i++)
+            SDL_SemWait(workDone);
+
+        Move move = {};
+        for (size_t i = 0; i < results.size(); i++)
+            if (results[i].fits && (!move.found || results[i].score > move.score))
+            {
+                move.piece = results[i].landed;
+                move.score = results[i].score;
+                move.found = true;
+            }
+        placements += Uint64(SDL_AtomicSet(&evaluated, 0));
+        moves++;
+        searchTicks += SDL_GetPerformanceCounter() - started;
+        return move;
+    }
+
+    // boards scored since the bot was made, the measure of its speed
+    Uint64 placementCount() const
+    {
+        return placements;
+    }
+
+    Uint64 moveCount() const
+    {
+        return moves;
+    }
+
+    double searchSeconds() const
+    {
+        return double(searchTicks) / SDL_GetPerformanceFrequency();
+    }
+
+    int threadCount() const
+    {
+        return int(workers.size()) + 1;
+    }
+
+private:
+    struct Result
+    {
+        bool fits = false;
+        TetrisPiece landed = {}; // where the piece comes to rest
+        double score = 0;
+    };
+
+    Weights weights;
+    const Board *board;
+    int follower;
+    vector<TetrisPiece> jobs; // the placements of the first piece, as spawned, before they drop
+    vector<TetrisPiece> followTable[TetrisPieces::Figures]; // the placements of each figure, the threads only read them
+    vector<Result> results; // one per job, written only by the thread that took it
+
+    vector<SDL_Thread *> workers;
+    SDL_sem *startWork, *workDone;
+    SDL_atomic_t nextJob;
+    SDL_atomic_t evaluated; // boards scored during this choose()
+    bool stopping;           // read by the workers after startWork, which orders it
+
+    Uint64 placements, moves, searchTicks;
+
+    static int SDLCALL searchWorker(void *data)
+    {
+        TetrisBot *bot = static_cast<TetrisBot *>(data);
+        for (;;)
+        {
+            SDL_SemWait(bot->startWork);
+            if (bot->stopping)
+                return 0;
+            bot->work();
+            SDL_SemPost(bot->workDone);
+        }
+    }
+
+    void work()
+    {
+        int scored = 0;
+        const vector<TetrisPiece> &next = followTable[follower];
+        for (int i = SDL_AtomicAdd(&nextJob, 1); i < int(jobs.size()); i = SDL_AtomicAdd(&nextJob, 1))
+        {
+            Result &result = results[i];
+            Board first = *board;
+            result.landed = jobs[i];
+            result.fits = drop(first, result.landed);
+            if (!result.fits)
+                continue;
+            int lines = first.clearLines();
+
+            // the placement is worth as much as the best follow-up it allows
+            bool followed = false;
+            for (size_t f = 0; f < next.size(); f++)
+            {
+                Board second = first;
+                TetrisPiece piece = next[f];
+                if (!drop(second, piece))
+                    continue;
+                int total = lines + second.clearLines();
+                double score = weights.lines * total + evaluate(second);
+                scored++;
+                if (!followed || score > result.score)
+                    result.score = score;
+                followed = true;
+            }
+            if (!followed)
+            {
+                // the next piece would end the game, any other placement is better
+                result.score = weights.lines * lines + evaluate(first) - 1e9;
+                scored++;
+            }
+        }
+        SDL_AtomicAdd(&evaluated, scored);
+    }
+
+    // every distinct rotation in every column, spawned at the top
+    static void placementsOf(int figure, vector<TetrisPiece> &placements)
+    {
+        for (int r = 0; r < TetrisPieces::Rotations; r++)
+        {
+            const TetrisPieces::State &state = TetrisPieces::state(figure, r);
+            if (!state.unique)
+                continue;
+            for (int left = 0; left + state.width <= Board::Cols; left++)
+            {
+                TetrisPiece piece = {figure, r, left - state.left, 0};
+                placements.push_back(piece);
+            }
+        }
+    }
+
+    // drops the piece from where it spawned and settles it, false if it does not fit up there
+    static bool drop(Board &target, TetrisPiece &piece)
+    {
+        if (!TetrisPieces::fits(target, piece))
+            return false;
+        TetrisPieces::drop(target, piece);
+        TetrisCell cells[4];
+        TetrisPieces::cells(piece, cells);
+        target.place(cells, 1);
+        return true;
+    }
+
+    double evaluate(const Board &target) const
+    {
+        // from the top down: a column's height is set by its first block, every empty cell below one is a hole
+        int heights[Board::Cols] = {0};
+        int holes = 0, height = 0;
+        Row covered = 0;
+        for (int y = 0; y < Board::Lines; y++)
+        {
+            Row row = target.row(y);
+            holes += Board::countColumns(Row(covered & ~row));
+            for (Row fresh = Row(row & ~covered); fresh; fresh &= fresh - 1)
+                heights[Board::lowestColumn(fresh)] = Board::Lines - y;
+            covered |= row;
+        }
+        int bumpiness = 0;
+        for (int x = 0; x < Board::Cols; x++)
+        {
+            height += heights[x];
+            if (x > 0)
+                bumpiness += abs(heights[x] - heights[x - 1]);
+        }
+        return weights.height * height + weights.holes * holes + weights.bumpiness * bumpiness;
+    }
+};
+
+#endif // TETRIS_BOT_H
@@ -0,0 +1,216 @@
+#ifndef TETRIS_PIECES_H
+#define TETRIS_PIECES_H
+
+#include <SDL2/SDL.h>
+#include "tetrisBoard.hpp"
+using namespace std;
+
+// TetrisPiece is a falling piece: which one, how far it is turned, and where the frame it spawned in is now.
+struct TetrisPiece
+{
+    int figure, rotation, x, y;
+};
+
+// TetrisPieceTable holds the seven pieces in each of their four rotations and the wall kicks of each turn,
+// built by the compiler from the spawn shapes; TetrisPieces keeps the one copy of it.
+struct TetrisPieceTable
+{
+    typedef TetrisCell Cell;
+    typedef Uint16 Row; // a line of a piece, shifted into the board's wider words
+
+    enum
+    {
+        Figures = 7,
+        Rotations = 4,
+        MaxKicks = 5
+    };
+
+    // one rotation of a piece; left and top are where its bounding box starts in the spawn frame
+    struct State
+    {
+        Cell cells[4];
+        Row rows[4]; // the cells as bits, one word per line of the box, bit 0 at its left edge
+        int left, top, width, height;
+        bool unique; // false if an earlier rotation of the same piece has the same shape, the bot skips those
+    };
+
+    // a shift tried after a turn, in order, until the piece fits; the first one is always no shift
+    struct Kick
+    {
+        int x, y;
+    };
+
+    struct Kicks
+    {
+        Kick shifts[MaxKicks];
+        int count;
+    };
+
+    State states[Figures][Rotations];
+    Kicks kicks[Figures][Rotations]; // for turning out of each rotation
+
+    static constexpr TetrisPieceTable build()
+    {
+        /*
+            0	1	2	3
+            4	5	6	7
+        */
+        const int figures[Figures][4] =
+            {
+                {0, 1, 2, 3}, // I
+                {0, 4, 5, 6}, // J
+                {2, 6, 5, 4}, // L
+                {1, 2, 5, 6}, // O
+                {2, 1, 5, 4}, // S
+                {1, 4, 5, 6}, // T
+                {0, 1, 5, 6}, // Z
+            };
+        TetrisPieceTable built{};
+        for (int f = 0; f < Figures; f++)
+        {
+            Cell cells[4] = {};
+            for (int i = 0; i < 4; i++)
+                cells[i] = Cell{figures[f][i] % 4, figures[f][i] / 4};
+            for (int r = 0; r < Rotations; r++)
+            {
+                State &state = built.states[f][r];
+                int left = cells[0].x, top = cells[0].y, right = cells[0].x, bottom = cells[0].y;
+                for (int i = 1; i < 4; i++)
+                {
+                    left = cells[i].x < left ? cells[i].x : left;
+                    top = cells[i].y < top ? cells[i].y : top;
+                    right = cells[i].x > right ? cells[i].x : right;
+                    bottom = cells[i].y > bottom ? cells[i].y : bottom;
+                }
+                state.left = left;
+                state.top = top;
+                state.width = right - left + 1;
+                state.height = bottom - top + 1;
+                for (int i = 0; i < 4; i++)
+                {
+                    state.cells[i] = cells[i];
+                    state.rows[cells[i].y - top] |= Row(1u << (cells[i].x - left));
+                }
+                state.unique = true;
+                for (int e = 0; e < r; e++)
+                {
+                    const State &earlier = built.states[f][e];
+                    bool same = earlier.width == state.width && earlier.height == state.height;
+                    for (int i = 0; i < 4; i++)
+                        same = same && earlier.rows[i] == state.rows[i];
+                    state.unique = state.unique && !same;
+                }
+
+                // the quarter turn to the next rotation, around the third cell, which stays where it is
+                Cell p = cells[2];
+                for (int i = 0; i < 4; i++)
+                    cells[i] = Cell{p.x - (cells[i].y - p.y), p.y + (cells[i].x - p.x)};
+            }
+        }
+
+        // kicks push a turned piece off a wall or a block: one column either way, two for the four wide I
+        for (int f = 0; f < Figures; f++)
+            for (int r = 0; r < Rotations; r++)
+            {
+                const State &next = built.states[f][(r + 1) % Rotations];
+                int reach = next.width == 4 || next.height == 4 ? 2 : 1;
+                Kicks &kicks = built.kicks[f][r];
+                kicks.shifts[kicks.count++] = Kick{0, 0};
+                for (int shift = 1; shift <= reach; shift++)
+                {
+                    kicks.shifts[kicks.count++] = Kick{-shift, 0};
+                    kicks.shifts[kicks.count++] = Kick{shift, 0};
+                }
+            }
+        return built;
+    }
+};
+
+// TetrisPieces knows the seven pieces in each of their four rotations, and the wall kicks tried when a turn
+// does not fit where the piece is. The tables are built by the compiler from the spawn shapes, turning each
+// a quarter clockwise around its third cell, so at run time a turn is a lookup and a piece on the board is a
+// few words ANDed with the lines it covers. The game, its bot and the benchmark all move pieces through here,
+// on a TetrisBoard of any size.
+class TetrisPieces
+{
+public:
+    typedef TetrisPieceTable::Cell Cell;
+    typedef TetrisPieceTable::Row Row;
+    typedef TetrisPieceTable::State State;
+    typedef TetrisPieceTable::Kick Kick;
+
+    enum
+    {
+        Figures = TetrisPieceTable::Figures,
+        Rotations = TetrisPieceTable::Rotations,
+        MaxKicks = TetrisPieceTable::MaxKicks
+    };
+
+    static TetrisPiece spawn(int figure)
+    {
+        TetrisPiece piece = {figure, 0, 0, 0};
+        return piece;
+    }
+
+    static constexpr const State &state(int figure, int rotation)
+    {
+        return table.states[figure][rotation];
+    }
+
+    static void cells(const TetrisPiece &piece, Cell out[4])
+    {
+        const State &shape = state(piece.figure, piece.rotation);
+        for (int i = 0; i < 4; i++)
+        {
+            out[i].x = shape.cells[i].x + piece.x;
+            out[i].y = shape.cells[i].y + piece.y;
+        }
+    }
+
+    // inside the walls and above the floor, on free cells; lines above the top are open
+    template <class Board>
+    static bool fits(const Board &board, const TetrisPiece &piece)
+    {
+        typedef typename Board::Row Line;
+        const State &shape = state(piece.figure, piece.rotation);
+        int left = piece.x + shape.left, top = piece.y + shape.top;
+        if (left < 0 || left + shape.width > Board::Cols || top + shape.height > Board::Lines)
+            return false;
+        for (int i = 0; i < shape.height; i++)
+            if (top + i >= 0 && (board.row(top + i) & Line(Line(shape.rows[i]) << left)))
+                return false;
+        return true;
+    }
+
+    // turns the piece a quarter clockwise with the first kick that fits, leaves it as it was if none does
+    template <class Board>
+    static bool turn(const Board &board, TetrisPiece &piece)
+    {
+        const TetrisPieceTable::Kicks &kicks = table.kicks[piece.figure][piece.rotation];
+        for (int i = 0; i < kicks.count; i++)
+        {
+            TetrisPiece turned = {piece.figure, (piece.rotation + 1) % Rotations, piece.x + kicks.shifts[i].x, piece.y + kicks.shifts[i].y};
+            if (fits(board, turned))
+            {
+                piece = turned;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // drops the piece straight down as far as it goes
+    template <class Board>
+    static void drop(const Board &board, TetrisPiece &piece)
+    {
+        TetrisPiece lower = piece;
+        for (lower.y++; fits(board, lower); lower.y++)
+            piece.y = lower.y;
+    }
+
+private:
+    // worked out while compiling, a build error here means a mistake in TetrisPieceTable::build()
+    static constexpr TetrisPieceTable table = TetrisPieceTable::build();
+};
+
+#endif // TETRIS_PIECES_H
@@ -0,0 +1,273 @@
+#ifndef TEXT_RENDERER_H
+#define TEXT_RENDERER_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include <iostream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "assetArchive.hpp"
+using namespace std;
+
+// FontRegistry opens every (font file, size) pair once for the whole process and keeps it open,
+// so games ask the registry for a font instead of calling TTF_OpenFont themselves.
+class FontRegistry
+{
+public:
+    FontRegistry() : archive(nullptr) {}
+    ~FontRegistry()
+    {
+        closeAll();
+    }
+
+    TTF_Font *get(const string &path, int size)
+    {
+        pair<string, int> key(path, size);
+        map<pair<string, int>, TTF_Font *>::iterator it = fonts.find(key);
+        if (it != fonts.end())
+            return it->second;
+
+        // a font in the asset archive is read from the mapping, which stays alive as long as the font
+        SDL_RWops *stream = archive ? archive->openRW(path) : nullptr;
+        TTF_Font *font = stream ? TTF_OpenFontRW(stream, 1, size) : TTF_OpenFont(path.c_str(), size);
+        if (!font)
+        {
+            cout << "Failed to load font " << path << ": " << TTF_GetError() << endl;
+            return nullptr; // not remembered, so a later call can try again
+        }
+        fonts[key] = font;
+        return font;
+    }
+
+    void setArchive(const AssetArchive *a)
+    {
+        archive = a;
+    }
+
+    void closeAll()
+    {
+        // must run before the last TTF_Quit, a font cannot be closed after SDL_ttf is shut down
+        for (map<pair<string, int>, TTF_Font *>::iterator it = fonts.begin(); it != fonts.end(); ++it)
+            TTF_CloseFont(it->second);
+        fonts.clear();
+    }
+
+private:
+    map<pair<string, int>, TTF_Font *> fonts;
+    const AssetArchive *archive;
+};
+
+// GlyphAtlas holds the printable ASCII glyphs of one font rasterized once into a single white texture.
+// Strings are then drawn as quads cut out of that texture and tinted with the vertex color.
+class GlyphAtlas
+{
+public:
+    enum
+    {
+        FirstGlyph = 32,
+        LastGlyph = 126,
+        AtlasWidth = 1024
+    };
+
+    struct Glyph
+    {
+        SDL_Rect src; // where the glyph sits in the atlas texture
+        int offsetX;  // horizontal offset of the glyph image from the pen position
+        int advance;  // how far the pen moves after this glyph
+    };
+
+    GlyphAtlas() : texture(nullptr), lineHeight(0) {}
+    ~GlyphAtlas()
+    {
+        if (texture)
+            SDL_DestroyTexture(texture);
+    }
+
+    bool build(SDL_Renderer *renderer, TTF_Font *font)
+    {
+        const SDL_Color white = {255, 255, 255, 255};
+        SDL_Surface *glyphSurfaces[LastGlyph - FirstGlyph + 1];
+        lineHeight = TTF_FontHeight(font);
+
+        // first pass: rasterize every glyph and lay the glyphs out in rows of the atlas
+        int x = 0, y = 0, rowHeight = 0;
+        for (int c = FirstGlyph; c <= LastGlyph; c++)
+        {
+            Glyph &glyph = glyphs[c - FirstGlyph];
+            int minx = 0, maxx = 0, miny = 0, maxy = 0, advance = 0;
+            TTF_GlyphMetrics(font, c, &minx, &maxx, &miny, &maxy, &advance);
+            glyph.advance = advance;
+            glyph.offsetX = minx < 0 ? minx : 0; // SDL_ttf shifts glyphs with a negative bearing to the right
+
+            SDL_Surface *surface = TTF_RenderGlyph_Blended(font, c, white);
+            glyphSurfaces[c - FirstGlyph] = surface;
+            int w = surface ? surface->w : 0;
+            int h = surface ? surface->h : 0;
+            if (x + w > AtlasWidth)
+            {
+                x = 0;
+                y += rowHeight + 1;
+                rowHeight = 0;
+            }
+            glyph.src = {x, y, w, h};
+            x += w + 1; // one pixel gap so linear filtering never bleeds into the neighbour
+            if (h > rowHeight)
+                rowHeight = h;
+        }
+
+        // second pass: copy the glyphs into one surface and upload it as a single texture
+        SDL_Surface *atlas = SDL_CreateRGBSurfaceWithFormat(0, AtlasWidth, y + rowHeight, 32, SDL_PIXELFORMAT_ARGB8888);
+        if (atlas)
+            SDL_FillRect(atlas, nullptr, SDL_MapRGBA(atlas->format, 255, 255, 255, 0));
+        for (int i = 0; i <= LastGlyph - FirstGlyph; i++)
+        {
+            if (!glyphSurfaces[i])
+                continue;
+            if (atlas)
+            {
+                SDL_SetSurfaceBlendMode(glyphSurfaces[i], SDL_BLENDMODE_NONE); // copy the alpha channel as it is
+                SDL_BlitSurface(glyphSurfaces[i], nullptr, atlas, &glyphs[i].src);
+            }
+            SDL_FreeSurface(glyphSurfaces[i]);
+        }
+        if (!atlas)
+        {
+            cout << "Failed to create glyph atlas: " << SDL_GetError() << endl;
+            return false;
+        }
+
+        texture = SDL_CreateTextureFromSurface(renderer, atlas);
+        atlasW = atlas->w;
+        atlasH = atlas->h;
+        SDL_FreeSurface(atlas);
+        if (!texture)
+        {
+            cout << "Failed to create glyph atlas texture: " << SDL_GetError() << endl;
+            return false;
+        }
+        SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+        return true;
+    }
+
+    const Glyph &glyph(char c) const
+    {
+        // anything outside printable ASCII is drawn as a question mark
+        if (c < FirstGlyph || c > LastGlyph)
+            c = '?';
+        return glyphs[c - FirstGlyph];
+    }
+
+    SDL_Texture *texture;
+    int lineHeight;
+    int atlasW, atlasH;
+
+private:
+    Glyph glyphs[LastGlyph - FirstGlyph + 1];
+};
+
+// TextRenderer draws strings from glyph atlases, one SDL_RenderGeometry call per string.
+// An atlas is baked the first time a font is used on this renderer and then kept for the whole game.
+class TextRenderer
+{
+public:
+    TextRenderer() : renderer(nullptr) {}
+    ~TextRenderer()
+    {
+        clear();
+    }
+
+    void setRenderer(SDL_Renderer *r)
+    {
+        renderer = r;
+    }
+
+    void clear()
+    {
+        // the atlas textures belong to the renderer, so this has to run before the renderer is destroyed
+        for (map<TTF_Font *, GlyphAtlas *>::iterator it = atlases.begin(); it != atlases.end(); ++it)
+            delete it->second;
+        atlases.clear();
+    }
+
+    // draws text with its top-left corner at (x, y) and returns the rectangle it covers
+    SDL_Rect draw(TTF_Font *font, const string &text, int x, int y, SDL_Color color)
+    {
+        SDL_Rect bounds = {x, y, 0, 0};
+        GlyphAtlas *atlas = atlasFor(font);
+        if (!atlas)
+            return bounds;
+
+        vertices.clear();
+        indices.clear();
+        float u = 1.0f / atlas->atlasW, v = 1.0f / atlas->atlasH;
+        int penX = x;
+        for (size_t i = 0; i < text.size(); i++)
+        {
+            const GlyphAtlas::Glyph &glyph = atlas->glyph(text[i]);
+            const SDL_Rect &src = glyph.src;
+            if (src.w > 0)
+            {
+                float left = float(penX + glyph.offsetX), top = float(y);
+                float right = left + src.w, bottom = top + src.h;
+                float s0 = src.x * u, t0 = src.y * v, s1 = (src.x + src.w) * u, t1 = (src.y + src.h) * v;
+
+                int first = int(vertices.size());
+                vertices.push_back({{left, top}, color, {s0, t0}});
+                vertices.push_back({{right, top}, color, {s1, t0}});
+                vertices.push_back({{right, bottom}, color, {s1, t1}});
+                vertices.push_back({{left, bottom}, color, {s0, t1}});
+                int quad[6] = {first, first + 1, first + 2, first, first + 2, first + 3};
+                indices.insert(indices.end(), quad, quad + 6);
+            }
+            penX += glyph.advance;
+        }
+        if (!vertices.empty())
+            SDL_RenderGeometry(renderer, atlas->texture, &vertices[0], int(vertices.size()), &indices[0], int(indices.size()));
+
+        bounds.w = penX - x;
+        bounds.h = atlas->lineHeight;
+        return bounds;
+    }
+
+    // size of text when drawn with draw(), without drawing anything
+    void measure(TTF_Font *font, const string &text, int *w, int *h)
+    {
+        GlyphAtlas *atlas = atlasFor(font);
+        int width = 0;
+        if (atlas)
+            for (size_t i = 0; i < text.size(); i++)
+                width += atlas->glyph(text[i]).advance;
+        if (w)
+            *w = width;
+        if (h)
+            *h = atlas ? atlas->lineHeight : 0;
+    }
+
+private:
+    SDL_Renderer *renderer;
+    map<TTF_Font *, GlyphAtlas *> atlases;
+    vector<SDL_Vertex> vertices; // reused between calls so drawing text does not allocate every frame
+    vector<int> indices;
+
+    GlyphAtlas *atlasFor(TTF_Font *font)
+    {
+        if (!font)
+            return nullptr;
+        map<TTF_Font *, GlyphAtlas *>::iterator it = atlases.find(font);
+        if (it != atlases.end())
+            return it->second;
+
+        GlyphAtlas *atlas = new GlyphAtlas;
+        if (!atlas->build(renderer, font))
+        {
+            delete atlas;
+            atlas = nullptr; // remembered as missing so a broken font is not rebuilt every frame
+        }
+        atlases[font] = atlas;
+        return atlas;
+    }
+};
+
+#endif // TEXT_RENDERER_H
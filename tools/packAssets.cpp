@@ -0,0 +1,212 @@
+// Packs the games' assets into one archive that AssetArchive maps at startup, built by "make -f src/makefile assets".
+// Images are decoded here once and stored as ARGB8888 pixels, so the games upload them without decoding;
+// every image named with --keyed is stored a second time with its white pixels made transparent, the way
+// AstroStrike keys its sprites. Everything else (sounds, fonts, text) is stored as it is.
+//
+//   packassets <archive> [--keyed <image>]... <file or directory>...
+//
+// Entry names are the paths as given, so run it from the directory the games run in.
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+#include "assetArchive.hpp"
+using namespace std;
+namespace fs = std::filesystem;
+
+struct PendingEntry
+{
+    string name;
+    ArchiveEntry entry;
+    vector<char> data;
+};
+
+bool isImage(const fs::path &path)
+{
+    string extension = AssetArchive::key(path.extension().string());
+    return extension == ".png" || extension == ".jpg" || extension == ".jpeg";
+}
+
+bool readFile(const fs::path &path, vector<char> &data)
+{
+    ifstream file(path, ios::binary);
+    if (!file.is_open())
+        return false;
+    data.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+    return true;
+}
+
+// decodes an image into texture-ready ARGB8888 rows, keyed images get alpha 0 where they were white
+bool decodeImage(const fs::path &path, bool keyWhite, PendingEntry &pending)
+{
+    SDL_Surface *loaded = IMG_Load(path.string().c_str());
+    if (!loaded)
+    {
+        cout << "Failed to decode " << path.string() << ": " << IMG_GetError() << endl;
+        return false;
+    }
+    if (keyWhite)
+        SDL_SetColorKey(loaded, SDL_TRUE, SDL_MapRGB(loaded->format, 255, 255, 255));
+    SDL_Surface *pixels = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_ARGB8888, 0); // the color key becomes alpha
+    SDL_FreeSurface(loaded);
+    if (!pixels)
+    {
+        cout << "Failed to convert " << path.string() << ": " << SDL_GetError() << endl;
+        return false;
+    }
+
+    ArchiveEntry &entry = pending.entry;
+    entry.kind = ArchiveEntry::Pixels;
+    entry.format = SDL_PIXELFORMAT_ARGB8888;
+    entry.width = Uint32(pixels->w);
+    entry.height = Uint32(pixels->h);
+    entry.pitch = Uint32(pixels->w * 4);
+    pending.data.resize(size_t(entry.pitch) * entry.height);
+    SDL_LockSurface(pixels);
+    for (int y = 0; y < pixels->h; y++)
+        memcpy(&pending.data[size_t(y) * entry.pitch], static_cast<char *>(pixels->pixels) + y * pixels->pitch, entry.pitch);
+    SDL_UnlockSurface(pixels);
+    SDL_FreeSurface(pixels);
+    return true;
+}
+
+bool addFile(const fs::path &path, const set<string> &keyed, vector<PendingEntry> &pending)
+{
+    string name = path.generic_string();
+    if (name.compare(0, 2, "./") == 0)
+        name = name.substr(2);
+
+    PendingEntry entry;
+    entry.name = name;
+    entry.entry = ArchiveEntry();
+    if (isImage(path))
+    {
+        if (!decodeImage(path, false, entry))
+            return false;
+        pending.push_back(entry);
+        if (keyed.count(AssetArchive::key(name)))
+        {
+            PendingEntry keyedEntry;
+            keyedEntry.name = name + "#keyed"; // the AssetCache ID of the keyed texture
+            keyedEntry.entry = ArchiveEntry();
+            if (!decodeImage(path, true, keyedEntry))
+                return false;
+            pending.push_back(keyedEntry);
+        }
+        return true;
+    }
+
+    entry.entry.kind = ArchiveEntry::Raw;
+    if (!readFile(path, entry.data))
+    {
+        cout << "Failed to read " << name << endl;
+        return false;
+    }
+    pending.push_back(entry);
+    return true;
+}
+
+bool writeArchive(const string &path, vector<PendingEntry> &pending)
+{
+    ArchiveHeader header;
+    memcpy(header.magic, "GMPK", 4);
+    header.version = ArchiveVersion;
+    header.entryCount = Uint32(pending.size());
+
+    string names;
+    for (size_t i = 0; i < pending.size(); i++)
+    {
+        pending[i].entry.nameOffset = Uint32(names.size());
+        pending[i].entry.nameLength = Uint32(pending[i].name.size());
+        names += pending[i].name;
+    }
+    header.nameBytes = Uint32(names.size());
+
+    // data starts after the table and names, every entry on an aligned offset
+    Uint64 offset = sizeof(ArchiveHeader) + pending.size() * sizeof(ArchiveEntry) + names.size();
+    for (size_t i = 0; i < pending.size(); i++)
+    {
+        offset = (offset + ArchiveAlignment - 1) / ArchiveAlignment * ArchiveAlignment;
+        pending[i].entry.offset = offset;
+        pending[i].entry.size = pending[i].data.size();
+        offset += pending[i].data.size();
+    }
+
+    string temporary = path + ".tmp";
+    ofstream file(temporary, ios::binary | ios::trunc);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    for (size_t i = 0; i < pending.size(); i++)
+        file.write(reinterpret_cast<const char *>(&pending[i].entry), sizeof(ArchiveEntry));
+    file.write(names.data(), names.size());
+    for (size_t i = 0; i < pending.size(); i++)
+    {
+        static const char padding[ArchiveAlignment] = {0};
+        Uint64 position = Uint64(file.tellp());
+        file.write(padding, streamsize(pending[i].entry.offset - position));
+        if (!pending[i].data.empty())
+            file.write(&pending[i].data[0], streamsize(pending[i].data.size()));
+    }
+    file.close();
+    if (!file)
+    {
+        cout << "Failed to write " << temporary << endl;
+        return false;
+    }
+    // the games may have the old archive mapped, so it is replaced in one step
+    error_code failed;
+    fs::rename(temporary, path, failed);
+    if (failed)
+    {
+        cout << "Failed to replace " << path << ": " << failed.message() << endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
+    {
+        cout << "usage: packassets <archive> [--keyed <image>]... <file or directory>..." << endl;
+        return 1;
+    }
+    IMG_Init(IMG_INIT_PNG | IMG_INIT_JPG);
+
+    set<string> keyed;
+    vector<fs::path> inputs;
+    for (int i = 2; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--keyed") == 0 && i + 1 < argc)
+            keyed.insert(AssetArchive::key(argv[++i]));
+        else
+            inputs.push_back(argv[i]);
+    }
+
+    vector<PendingEntry> pending;
+    for (size_t i = 0; i < inputs.size(); i++)
+    {
+        if (fs::is_directory(inputs[i]))
+        {
+            for (fs::recursive_directory_iterator it(inputs[i]), end; it != end; ++it)
+                if (it->is_regular_file() && !addFile(it->path(), keyed, pending))
+                    return 1;
+        }
+        else if (!addFile(inputs[i], keyed, pending))
+            return 1;
+    }
+
+    if (!writeArchive(argv[1], pending))
+        return 1;
+    Uint64 bytes = 0;
+    for (size_t i = 0; i < pending.size(); i++)
+        bytes += pending[i].data.size();
+    cout << "Packed " << pending.size() << " entries, " << bytes / 1024 << " KiB, into " << argv[1] << endl;
+    IMG_Quit();
+    return 0;
+}